@@ -2,258 +2,4664 @@
 #include <vector>
 #include <cmath>
 #include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <random>
 #include <fstream>
 #include <iomanip>
+#include <sstream>
+#include <string>
 #include <map>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <new>
+#include <limits>
+#include <numeric>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <chrono>
+#include <deque>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MDP_ENGINE_X86_KERNELS 1
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MDP_ENGINE_MMAP 1
+#endif
+
+template <typename T, std::size_t Alignment = 64>
+struct AlignedAllocator {
+    using value_type = T;
+    
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+    
+    AlignedAllocator() = default;
+    
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+    
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+    
+    void deallocate(T* p, std::size_t) {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+    
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+    
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+enum class KernelIsa {
+    Auto,
+    Scalar,
+    Avx2,
+    Avx512
+};
+
+// Dot product and first-index argmax used by the Bellman backup, in double
+// and float. The vector variants are compiled with per-function target
+// attributes and chosen at runtime, so one binary runs on hosts with and
+// without AVX2/AVX-512.
+struct VectorKernels {
+    template <typename Real>
+    static Real dotScalar(const Real* a, const Real* b, int n) {
+        Real sum = 0;
+        for (int i = 0; i < n; ++i) {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+    
+    template <typename Real>
+    static int argmaxScalar(const Real* values, int n) {
+        int best = 0;
+        for (int i = 1; i < n; ++i) {
+            if (values[i] > values[best]) best = i;
+        }
+        return best;
+    }
+
+#ifdef MDP_ENGINE_X86_KERNELS
+    __attribute__((target("avx2,fma")))
+    static double dotAvx2(const double* a, const double* b, int n) {
+        __m256d acc0 = _mm256_setzero_pd();
+        __m256d acc1 = _mm256_setzero_pd();
+        int i = 0;
+        for (; i + 8 <= n; i += 8) {
+            acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc0);
+            acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), acc1);
+        }
+        if (i + 4 <= n) {
+            acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc0);
+            i += 4;
+        }
+        acc0 = _mm256_add_pd(acc0, acc1);
+        __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+        double sum = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+        for (; i < n; ++i) {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+    
+    __attribute__((target("avx2")))
+    static int argmaxAvx2(const double* values, int n) {
+        if (n < 8) return argmaxScalar(values, n);
+        __m256d best = _mm256_loadu_pd(values);
+        int i = 4;
+        for (; i + 4 <= n; i += 4) {
+            best = _mm256_max_pd(best, _mm256_loadu_pd(values + i));
+        }
+        __m128d half = _mm_max_pd(_mm256_castpd256_pd128(best), _mm256_extractf128_pd(best, 1));
+        double maxValue = _mm_cvtsd_f64(_mm_max_sd(half, _mm_unpackhi_pd(half, half)));
+        for (; i < n; ++i) {
+            maxValue = std::max(maxValue, values[i]);
+        }
+        
+        __m256d target = _mm256_set1_pd(maxValue);
+        for (i = 0; i + 4 <= n; i += 4) {
+            int mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(values + i), target, _CMP_EQ_OQ));
+            if (mask) return i + __builtin_ctz(mask);
+        }
+        for (; i < n; ++i) {
+            if (values[i] == maxValue) return i;
+        }
+        return 0;
+    }
+    
+    __attribute__((target("avx512f")))
+    static double dotAvx512(const double* a, const double* b, int n) {
+        __m512d acc0 = _mm512_setzero_pd();
+        __m512d acc1 = _mm512_setzero_pd();
+        int i = 0;
+        for (; i + 16 <= n; i += 16) {
+            acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), acc0);
+            acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8), acc1);
+        }
+        for (; i < n; i += 8) {
+            __mmask8 mask = (n - i >= 8) ? 0xFF : static_cast<__mmask8>((1u << (n - i)) - 1);
+            acc0 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, a + i), _mm512_maskz_loadu_pd(mask, b + i), acc0);
+        }
+        alignas(64) double lanes[8];
+        _mm512_store_pd(lanes, _mm512_add_pd(acc0, acc1));
+        return ((lanes[0] + lanes[4]) + (lanes[1] + lanes[5])) + ((lanes[2] + lanes[6]) + (lanes[3] + lanes[7]));
+    }
+    
+    __attribute__((target("avx512f")))
+    static int argmaxAvx512(const double* values, int n) {
+        const __m512d lowest = _mm512_set1_pd(-std::numeric_limits<double>::infinity());
+        __m512d best = lowest;
+        for (int i = 0; i < n; i += 8) {
+            __mmask8 mask = (n - i >= 8) ? 0xFF : static_cast<__mmask8>((1u << (n - i)) - 1);
+            best = _mm512_mask_max_pd(best, mask, best, _mm512_maskz_loadu_pd(mask, values + i));
+        }
+        alignas(64) double lanes[8];
+        _mm512_store_pd(lanes, best);
+        double maxValue = *std::max_element(lanes, lanes + 8);
+        
+        __m512d target = _mm512_set1_pd(maxValue);
+        for (int i = 0; i < n; i += 8) {
+            __mmask8 mask = (n - i >= 8) ? 0xFF : static_cast<__mmask8>((1u << (n - i)) - 1);
+            __mmask8 hits = _mm512_mask_cmp_pd_mask(mask, _mm512_maskz_loadu_pd(mask, values + i), target, _CMP_EQ_OQ);
+            if (hits) return i + __builtin_ctz(hits);
+        }
+        return 0;
+    }
+    
+    __attribute__((target("avx2,fma")))
+    static float dotAvx2(const float* a, const float* b, int n) {
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        int i = 0;
+        for (; i + 16 <= n; i += 16) {
+            acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+            acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+        }
+        if (i + 8 <= n) {
+            acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+            i += 8;
+        }
+        acc0 = _mm256_add_ps(acc0, acc1);
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        float sum = _mm_cvtss_f32(_mm_add_ss(half, _mm_shuffle_ps(half, half, 1)));
+        for (; i < n; ++i) {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+    
+    __attribute__((target("avx2")))
+    static int argmaxAvx2(const float* values, int n) {
+        if (n < 16) return argmaxScalar(values, n);
+        __m256 best = _mm256_loadu_ps(values);
+        int i = 8;
+        for (; i + 8 <= n; i += 8) {
+            best = _mm256_max_ps(best, _mm256_loadu_ps(values + i));
+        }
+        __m128 half = _mm_max_ps(_mm256_castps256_ps128(best), _mm256_extractf128_ps(best, 1));
+        half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+        float maxValue = _mm_cvtss_f32(_mm_max_ss(half, _mm_shuffle_ps(half, half, 1)));
+        for (; i < n; ++i) {
+            maxValue = std::max(maxValue, values[i]);
+        }
+        
+        __m256 target = _mm256_set1_ps(maxValue);
+        for (i = 0; i + 8 <= n; i += 8) {
+            int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(values + i), target, _CMP_EQ_OQ));
+            if (mask) return i + __builtin_ctz(mask);
+        }
+        for (; i < n; ++i) {
+            if (values[i] == maxValue) return i;
+        }
+        return 0;
+    }
+    
+    __attribute__((target("avx512f")))
+    static float dotAvx512(const float* a, const float* b, int n) {
+        __m512 acc0 = _mm512_setzero_ps();
+        __m512 acc1 = _mm512_setzero_ps();
+        int i = 0;
+        for (; i + 32 <= n; i += 32) {
+            acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+            acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), acc1);
+        }
+        for (; i < n; i += 16) {
+            __mmask16 mask = (n - i >= 16) ? 0xFFFF : static_cast<__mmask16>((1u << (n - i)) - 1);
+            acc0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i), acc0);
+        }
+        alignas(64) float lanes[16];
+        _mm512_store_ps(lanes, _mm512_add_ps(acc0, acc1));
+        __m256 quarter = _mm256_add_ps(_mm256_load_ps(lanes), _mm256_load_ps(lanes + 8));
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(quarter), _mm256_extractf128_ps(quarter, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        return _mm_cvtss_f32(_mm_add_ss(half, _mm_shuffle_ps(half, half, 1)));
+    }
+    
+    __attribute__((target("avx512f")))
+    static int argmaxAvx512(const float* values, int n) {
+        const __m512 lowest = _mm512_set1_ps(-std::numeric_limits<float>::infinity());
+        __m512 best = lowest;
+        for (int i = 0; i < n; i += 16) {
+            __mmask16 mask = (n - i >= 16) ? 0xFFFF : static_cast<__mmask16>((1u << (n - i)) - 1);
+            best = _mm512_mask_max_ps(best, mask, best, _mm512_maskz_loadu_ps(mask, values + i));
+        }
+        alignas(64) float lanes[16];
+        _mm512_store_ps(lanes, best);
+        float maxValue = *std::max_element(lanes, lanes + 16);
+        
+        __m512 target = _mm512_set1_ps(maxValue);
+        for (int i = 0; i < n; i += 16) {
+            __mmask16 mask = (n - i >= 16) ? 0xFFFF : static_cast<__mmask16>((1u << (n - i)) - 1);
+            __mmask16 hits = _mm512_mask_cmp_ps_mask(mask, _mm512_maskz_loadu_ps(mask, values + i), target, _CMP_EQ_OQ);
+            if (hits) return i + __builtin_ctz(hits);
+        }
+        return 0;
+    }
+#endif
+    
+    static bool supported(KernelIsa isa) {
+#ifdef MDP_ENGINE_X86_KERNELS
+        switch (isa) {
+            case KernelIsa::Avx512: return __builtin_cpu_supports("avx512f");
+            case KernelIsa::Avx2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+            default: return true;
+        }
+#else
+        return isa == KernelIsa::Scalar || isa == KernelIsa::Auto;
+#endif
+    }
+};
+
+template <typename Real>
+struct BellmanKernels {
+    KernelIsa isa;
+    const char* name;
+    Real (*dot)(const Real* a, const Real* b, int n);
+    int (*argmax)(const Real* values, int n);
+    
+    static bool supported(KernelIsa isa) {
+        return VectorKernels::supported(isa);
+    }
+    
+    // Returns the requested ISA, or the best supported one below it.
+    static const BellmanKernels& select(KernelIsa requested = KernelIsa::Auto) {
+        static const BellmanKernels scalar{KernelIsa::Scalar, "scalar", VectorKernels::dotScalar<Real>,
+                                           VectorKernels::argmaxScalar<Real>};
+#ifdef MDP_ENGINE_X86_KERNELS
+        static const BellmanKernels avx2{KernelIsa::Avx2, "avx2", VectorKernels::dotAvx2, VectorKernels::argmaxAvx2};
+        static const BellmanKernels avx512{KernelIsa::Avx512, "avx512", VectorKernels::dotAvx512,
+                                           VectorKernels::argmaxAvx512};
+        
+        if ((requested == KernelIsa::Auto || requested == KernelIsa::Avx512) && supported(KernelIsa::Avx512)) {
+            return avx512;
+        }
+        if (requested != KernelIsa::Scalar && supported(KernelIsa::Avx2)) {
+            return avx2;
+        }
+#endif
+        (void)requested;
+        return scalar;
+    }
+};
+
+// Continuation table G(y) = sum_d P(d) V(max(0, y - d)) for y in [0, N] with
+// the state capacity and demand support fixed at compile time. Values and PMF
+// are copied into zero-padded std::arrays, and each block of levels keeps its
+// accumulators in registers across a constant-trip, fully unrolled demand
+// loop. Zero padding leaves the result unchanged. The dispatch table maps a
+// runtime (states, support) pair to the tightest bucket and counts the hits
+// per bucket; sizes beyond the largest bucket use the generic loop.
+template <typename Real>
+struct ContinuationKernels {
+    using Kernel = void (*)(const Real* values, int states, const double* pmf, const double* tail,
+                            int support, Real* out);
+    
+    struct Entry {
+        int states;
+        int support;
+        Kernel scalar;
+        Kernel avx2;
+        Kernel avx512;
+        mutable std::atomic<long long> hits{0};
+        
+        Kernel kernel(KernelIsa isa) const {
+            switch (isa) {
+                case KernelIsa::Avx512: return avx512;
+                case KernelIsa::Avx2: return avx2;
+                default: return scalar;
+            }
+        }
+    };
+    
+    template <int States, int Support>
+    __attribute__((always_inline))
+    static inline void convolve(const Real* values, int states, const double* pmf, const double* tail,
+                                int support, Real* out) {
+        // v[Support + i] = V(i); the leading zeros absorb the terms with d > y.
+        constexpr int Block = 64 / sizeof(Real) * 4;
+        static_assert(States % Block == 0, "bucket capacity must be whole blocks");
+        std::array<Real, Support + States> v{};
+        std::array<Real, Support> p{};
+        std::copy(values, values + states, v.begin() + Support);
+        for (int d = 0; d < support; ++d) {
+            p[d] = static_cast<Real>(pmf[d]);
+        }
+        
+        for (int base = 0; base < states; base += Block) {
+            std::array<Real, Block> g{};
+            for (int d = 0; d < Support; ++d) {
+                const Real* slice = v.data() + Support + base - d;
+                for (int lane = 0; lane < Block; ++lane) {
+                    g[lane] += p[d] * slice[lane];
+                }
+            }
+            std::copy(g.begin(), g.begin() + std::min(Block, states - base), out + base);
+        }
+        
+        // Demand above y empties the shelf.
+        Real empty = v[Support];
+        for (int y = 0; y < std::min(support, states); ++y) {
+            out[y] += static_cast<Real>(tail[y]) * empty;
+        }
+    }
+    
+    template <int States, int Support>
+    static void fixedScalar(const Real* values, int states, const double* pmf, const double* tail,
+                            int support, Real* out) {
+        convolve<States, Support>(values, states, pmf, tail, support, out);
+    }
+
+#ifdef MDP_ENGINE_X86_KERNELS
+    template <int States, int Support>
+    __attribute__((target("avx2,fma")))
+    static void fixedAvx2(const Real* values, int states, const double* pmf, const double* tail,
+                          int support, Real* out) {
+        convolve<States, Support>(values, states, pmf, tail, support, out);
+    }
+    
+    template <int States, int Support>
+    __attribute__((target("avx512f")))
+    static void fixedAvx512(const Real* values, int states, const double* pmf, const double* tail,
+                            int support, Real* out) {
+        convolve<States, Support>(values, states, pmf, tail, support, out);
+    }
+    
+    template <int States, int Support>
+    static constexpr Entry bucket() {
+        return {States, Support, fixedScalar<States, Support>, fixedAvx2<States, Support>,
+                fixedAvx512<States, Support>};
+    }
+#else
+    template <int States, int Support>
+    static constexpr Entry bucket() {
+        return {States, Support, fixedScalar<States, Support>, fixedScalar<States, Support>,
+                fixedScalar<States, Support>};
+    }
+#endif
+    
+    static const std::array<Entry, 18>& table() {
+        static const std::array<Entry, 18> entries{{
+            bucket<64, 8>(), bucket<64, 16>(), bucket<64, 24>(),
+            bucket<64, 32>(), bucket<64, 48>(), bucket<64, 64>(),
+            bucket<256, 8>(), bucket<256, 16>(), bucket<256, 24>(),
+            bucket<256, 32>(), bucket<256, 48>(), bucket<256, 64>(),
+            bucket<1024, 8>(), bucket<1024, 16>(), bucket<1024, 24>(),
+            bucket<1024, 32>(), bucket<1024, 48>(), bucket<1024, 64>(),
+        }};
+        return entries;
+    }
+    
+    static std::atomic<long long>& genericHits() {
+        static std::atomic<long long> hits{0};
+        return hits;
+    }
+    
+    // Tightest bucket holding the sizes, or nullptr for the generic loop.
+    // Support padding costs work on every level; state capacity only costs
+    // stack space, since blocks past the real state count are skipped.
+    static const Entry* select(int states, int support) {
+        const Entry* best = nullptr;
+        for (const Entry& entry : table()) {
+            if (entry.states < states || entry.support < support) continue;
+            if (!best || entry.support < best->support ||
+                (entry.support == best->support && entry.states < best->states)) {
+                best = &entry;
+            }
+        }
+        return best;
+    }
+    
+    static void report(std::ostream& out) {
+        long long generic = genericHits().load();
+        long long total = generic;
+        for (const Entry& entry : table()) total += entry.hits.load();
+        
+        auto row = [&](const std::string& label, long long hits) {
+            double share = (total > 0) ? 100.0 * hits / total : 0.0;
+            out << "  " << std::setw(24) << std::left << label << std::right << std::setw(10) << hits
+                << std::setw(8) << std::fixed << std::setprecision(1) << share << "%\n";
+        };
+        for (const Entry& entry : table()) {
+            if (entry.hits.load() == 0) continue;
+            row("fixed<" + std::to_string(entry.states) + ", " + std::to_string(entry.support) + ">",
+                entry.hits.load());
+        }
+        row("generic", generic);
+        out.unsetf(std::ios::floatfield);
+    }
+};
+
+// Discretized normal demand on {0, ..., floor(mean + 4 std)}. The PMF keeps the
+// raw density values at the integer points (it is not renormalized), so every
+// consumer sees exactly the probabilities the solver uses.
+class DemandDistribution {
+private:
+    double mean;
+    double stddev;
+    int maxDemand;
+    double mass;
+    AlignedVector<double> pmf;
+    AlignedVector<double> cdf;
+    AlignedVector<double> tail;
+    AlignedVector<double> loss;
+    AlignedVector<double> reversedPmf;
+    AlignedVector<float> reversedPmfSingle;
+
+public:
+    DemandDistribution(double demMean, double demStd)
+        : mean(demMean), stddev(demStd),
+          maxDemand(std::max(0, static_cast<int>(demMean + 4 * demStd))), mass(0.0) {
+        
+        pmf.resize(maxDemand + 1);
+        cdf.resize(maxDemand + 1);
+        tail.resize(maxDemand + 1);
+        
+        for (int d = 0; d <= maxDemand; ++d) {
+            pmf[d] = normalPDF(static_cast<double>(d), mean, stddev);
+            mass += pmf[d];
+            cdf[d] = mass;
+        }
+        
+        for (int d = 0; d <= maxDemand; ++d) {
+            tail[d] = std::max(0.0, mass - cdf[d]);
+        }
+        
+        // First-order loss L(s) = E[(D - s)^+], via L(s + 1) = L(s) - P(D > s).
+        loss.resize(maxDemand + 1);
+        loss[0] = 0.0;
+        for (int d = 1; d <= maxDemand; ++d) {
+            loss[0] += d * pmf[d];
+        }
+        for (int d = 1; d <= maxDemand; ++d) {
+            loss[d] = std::max(0.0, loss[d - 1] - tail[d - 1]);
+        }
+        
+        reversedPmf.assign(pmf.rbegin(), pmf.rend());
+        reversedPmfSingle.assign(reversedPmf.begin(), reversedPmf.end());
+    }
+    
+    static double normalPDF(double x, double mean, double std) {
+        const double PI = 3.14159265358979323846;
+        double exponent = -0.5 * std::pow((x - mean) / std, 2);
+        return (1.0 / (std * std::sqrt(2 * PI))) * std::exp(exponent);
+    }
+    
+    double demandMean() const { return mean; }
+    double demandStd() const { return stddev; }
+    int maxValue() const { return maxDemand; }
+    int support() const { return maxDemand + 1; }
+    double totalMass() const { return mass; }
+    
+    double probability(int d) const {
+        return (d < 0 || d > maxDemand) ? 0.0 : pmf[d];
+    }
+    
+    // Mass of demand strictly greater than d.
+    double tailMass(int d) const {
+        if (d < 0) return mass;
+        return (d > maxDemand) ? 0.0 : tail[d];
+    }
+    
+    double expectedDemand() const {
+        return loss[0];
+    }
+    
+    double expectedShortage(int level) const {
+        if (level <= 0) return loss[0] - level * mass;
+        return (level > maxDemand) ? 0.0 : loss[level];
+    }
+    
+    double expectedSales(int level) const {
+        return loss[0] - expectedShortage(std::max(0, level));
+    }
+    
+    const double* pmfData() const { return pmf.data(); }
+    const double* cdfData() const { return cdf.data(); }
+    const double* tailData() const { return tail.data(); }
+    
+    // reversedPmfData()[maxValue() - d] == probability(d), so sum_d P(d) V[y - d]
+    // over an interior range is a forward dot product with a contiguous V slice.
+    const double* reversedPmfData() const { return reversedPmf.data(); }
+    
+    // The same table in the engine's value type, for float sweeps.
+    template <typename Real>
+    const Real* reversedPmfAs() const {
+        if constexpr (std::is_same<Real, float>::value) {
+            return reversedPmfSingle.data();
+        } else {
+            return reversedPmf.data();
+        }
+    }
+    
+    bool matches(double demMean, double demStd) const {
+        return mean == demMean && stddev == demStd;
+    }
+    
+    int sample(std::mt19937& gen) const {
+        std::uniform_real_distribution<double> uniform(0.0, mass);
+        auto it = std::upper_bound(cdf.begin(), cdf.end(), uniform(gen));
+        return std::min(maxDemand, static_cast<int>(it - cdf.begin()));
+    }
+};
+
+// Runs tasks [0, count) and returns only after every task has finished.
+// Sweeps split their state ranges through this interface, so they run on
+// either executor below.
+class ParallelExecutor {
+public:
+    virtual ~ParallelExecutor() = default;
+    virtual int size() const = 0;
+    virtual void run(int count, const std::function<void(int)>& fn) = 0;
+};
+
+// Persistent workers for data-parallel sweeps. run() hands out task indices
+// dynamically, lets the calling thread help, and returns only after every task
+// has finished, so each call acts as a barrier.
+class ThreadPool : public ParallelExecutor {
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable workReady;
+    std::condition_variable workDone;
+    const std::function<void(int)>* task = nullptr;
+    int taskCount = 0;
+    std::atomic<int> nextTask{0};
+    int activeWorkers = 0;
+    unsigned long generation = 0;
+    bool stopping = false;
+    
+    void drain() {
+        for (int i = nextTask.fetch_add(1); i < taskCount; i = nextTask.fetch_add(1)) {
+            (*task)(i);
+        }
+    }
+    
+    void workerLoop() {
+        unsigned long seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                workReady.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            
+            drain();
+            
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--activeWorkers == 0) {
+                workDone.notify_one();
+            }
+        }
+    }
+
+public:
+    explicit ThreadPool(int threads) {
+        for (int i = 1; i < threads; ++i) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+    
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        workReady.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    int size() const override {
+        return static_cast<int>(workers.size()) + 1;
+    }
+    
+    void run(int count, const std::function<void(int)>& fn) override {
+        if (workers.empty() || count <= 1) {
+            for (int i = 0; i < count; ++i) fn(i);
+            return;
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task = &fn;
+            taskCount = count;
+            nextTask.store(0);
+            activeWorkers = static_cast<int>(workers.size());
+            ++generation;
+        }
+        workReady.notify_all();
+        
+        drain();
+        
+        std::unique_lock<std::mutex> lock(mutex);
+        workDone.wait(lock, [&] { return activeWorkers == 0; });
+        task = nullptr;
+    }
+};
+
+// Work-stealing workers for jobs of very uneven size. Each worker owns a
+// deque and takes tasks from its front; an idle worker steals from the front
+// of another deque. wait() starts the submitted jobs largest cost first,
+// dealt round-robin, so every deque is ordered by cost and steals also take
+// the largest job left. run() may be called from inside a job: the calling
+// worker pushes helper tasks onto the front of its own deque, drains the
+// index range itself, and idle workers steal the helpers to join in.
+class WorkStealingScheduler : public ParallelExecutor {
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+    
+    struct Job {
+        std::function<void()> task;
+        double cost;
+    };
+    
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+    std::vector<Job> pending;
+    std::mutex mutex;
+    std::condition_variable workReady;
+    std::condition_variable jobsDone;
+    std::atomic<long long> queued{0};
+    std::atomic<long long> unfinished{0};
+    std::atomic<long long> stolen{0};
+    unsigned nextQueue = 0;
+    bool stopping = false;
+    
+    static inline thread_local const WorkStealingScheduler* currentScheduler = nullptr;
+    static inline thread_local int currentWorker = -1;
+    
+    int callingWorker() const {
+        return (currentScheduler == this) ? currentWorker : -1;
+    }
+    
+    void push(int worker, std::function<void()> task, bool front) {
+        {
+            std::lock_guard<std::mutex> lock(queues[worker]->mutex);
+            if (front) {
+                queues[worker]->tasks.push_front(std::move(task));
+            } else {
+                queues[worker]->tasks.push_back(std::move(task));
+            }
+        }
+        queued.fetch_add(1);
+    }
+    
+    bool take(int worker, std::function<void()>& task) {
+        std::lock_guard<std::mutex> lock(queues[worker]->mutex);
+        if (queues[worker]->tasks.empty()) return false;
+        task = std::move(queues[worker]->tasks.front());
+        queues[worker]->tasks.pop_front();
+        queued.fetch_sub(1);
+        return true;
+    }
+    
+    bool runOne(int worker) {
+        std::function<void()> task;
+        if (!take(worker, task)) {
+            int count = static_cast<int>(queues.size());
+            bool found = false;
+            for (int offset = 1; offset < count && !found; ++offset) {
+                found = take((worker + offset) % count, task);
+            }
+            if (!found) return false;
+            stolen.fetch_add(1);
+        }
+        task();
+        return true;
+    }
+    
+    void wake() {
+        std::lock_guard<std::mutex> lock(mutex);
+        workReady.notify_all();
+    }
+    
+    void workerLoop(int worker) {
+        currentScheduler = this;
+        currentWorker = worker;
+        for (;;) {
+            if (runOne(worker)) continue;
+            std::unique_lock<std::mutex> lock(mutex);
+            workReady.wait(lock, [&] { return stopping || queued.load() > 0; });
+            if (stopping && queued.load() == 0) return;
+        }
+    }
+
+public:
+    explicit WorkStealingScheduler(int threads) {
+        int count = std::max(1, threads);
+        for (int i = 0; i < count; ++i) {
+            queues.push_back(std::make_unique<WorkerQueue>());
+        }
+        for (int i = 0; i < count; ++i) {
+            workers.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+    
+    ~WorkStealingScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        workReady.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+    
+    WorkStealingScheduler(const WorkStealingScheduler&) = delete;
+    WorkStealingScheduler& operator=(const WorkStealingScheduler&) = delete;
+    
+    int size() const override {
+        return static_cast<int>(workers.size());
+    }
+    
+    long long steals() const {
+        return stolen.load();
+    }
+    
+    // Queues a job for the next wait(); cost only orders the start.
+    void submit(std::function<void()> task, double cost) {
+        pending.push_back({std::move(task), cost});
+    }
+    
+    // Starts the submitted jobs and blocks until all of them have finished.
+    // Must be called from outside the workers.
+    void wait() {
+        std::stable_sort(pending.begin(), pending.end(),
+                         [](const Job& a, const Job& b) { return a.cost > b.cost; });
+        unfinished.fetch_add(static_cast<long long>(pending.size()));
+        for (Job& job : pending) {
+            auto task = [this, body = std::move(job.task)] {
+                body();
+                if (unfinished.fetch_sub(1) == 1) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    jobsDone.notify_all();
+                }
+            };
+            push(static_cast<int>(nextQueue++ % queues.size()), std::move(task), false);
+        }
+        pending.clear();
+        wake();
+        
+        std::unique_lock<std::mutex> lock(mutex);
+        jobsDone.wait(lock, [&] { return unfinished.load() == 0; });
+    }
+    
+    void run(int count, const std::function<void(int)>& fn) override {
+        if (count <= 0) return;
+        
+        struct Group {
+            std::atomic<int> next{0};
+            std::atomic<int> done{0};
+            std::mutex mutex;
+            std::condition_variable finished;
+        };
+        auto group = std::make_shared<Group>();
+        // Helpers that start after the range is drained return at once and
+        // never touch fn.
+        auto drain = [group, &fn, count] {
+            for (int i = group->next.fetch_add(1); i < count; i = group->next.fetch_add(1)) {
+                fn(i);
+                if (group->done.fetch_add(1) + 1 == count) {
+                    std::lock_guard<std::mutex> lock(group->mutex);
+                    group->finished.notify_all();
+                }
+            }
+        };
+        
+        int worker = callingWorker();
+        int helpers = std::min(count, size()) - 1;
+        for (int i = 0; i < helpers; ++i) {
+            if (worker >= 0) {
+                push(worker, drain, true);
+            } else {
+                push(i % size(), drain, true);
+            }
+        }
+        if (helpers > 0) wake();
+        
+        drain();
+        std::unique_lock<std::mutex> lock(group->mutex);
+        group->finished.wait(lock, [&] { return group->done.load() == count; });
+    }
+};
+
+// Binary max-heap over the indices [0, n) with a position table, so the
+// priority of any index can be raised or lowered in O(log n).
+class IndexedMaxHeap {
+private:
+    std::vector<int> heap;
+    std::vector<int> position;
+    std::vector<double> priority;
+    
+    bool before(int a, int b) const {
+        return priority[heap[a]] > priority[heap[b]];
+    }
+    
+    void swapNodes(int a, int b) {
+        std::swap(heap[a], heap[b]);
+        position[heap[a]] = a;
+        position[heap[b]] = b;
+    }
+    
+    void siftUp(int node) {
+        while (node > 0 && before(node, (node - 1) / 2)) {
+            swapNodes(node, (node - 1) / 2);
+            node = (node - 1) / 2;
+        }
+    }
+    
+    void siftDown(int node) {
+        int n = static_cast<int>(heap.size());
+        for (;;) {
+            int best = node;
+            int left = 2 * node + 1;
+            int right = left + 1;
+            if (left < n && before(left, best)) best = left;
+            if (right < n && before(right, best)) best = right;
+            if (best == node) return;
+            swapNodes(node, best);
+            node = best;
+        }
+    }
+
+public:
+    explicit IndexedMaxHeap(int n = 0) : position(n, -1), priority(n, 0.0) {}
+    
+    bool empty() const { return heap.empty(); }
+    int top() const { return heap.front(); }
+    double topPriority() const { return priority[heap.front()]; }
+    bool contains(int index) const { return position[index] >= 0; }
+    
+    void set(int index, double value) {
+        if (position[index] < 0) {
+            position[index] = static_cast<int>(heap.size());
+            heap.push_back(index);
+            priority[index] = value;
+            siftUp(position[index]);
+        } else {
+            double old = priority[index];
+            priority[index] = value;
+            if (value > old) siftUp(position[index]);
+            else siftDown(position[index]);
+        }
+    }
+    
+    void remove(int index) {
+        int node = position[index];
+        if (node < 0) return;
+        swapNodes(node, static_cast<int>(heap.size()) - 1);
+        heap.pop_back();
+        position[index] = -1;
+        if (node < static_cast<int>(heap.size())) {
+            siftUp(node);
+            siftDown(node);
+        }
+    }
+    
+    int pop() {
+        int index = heap.front();
+        remove(index);
+        return index;
+    }
+    
+    void clear() {
+        for (int index : heap) position[index] = -1;
+        heap.clear();
+    }
+};
+
+// Point-update / range-max tree over doubles. Ties resolve to the smallest
+// index, matching the first-index argmax used by the sweeps.
+class MaxSegmentTree {
+private:
+    int size = 0;
+    std::vector<std::pair<double, int>> tree;
+    
+    static std::pair<double, int> better(const std::pair<double, int>& a, const std::pair<double, int>& b) {
+        if (a.first != b.first) return (a.first > b.first) ? a : b;
+        return (a.second < b.second) ? a : b;
+    }
+
+public:
+    void assign(const std::vector<double>& values) {
+        size = static_cast<int>(values.size());
+        tree.assign(2 * size, {-std::numeric_limits<double>::infinity(), -1});
+        for (int i = 0; i < size; ++i) {
+            tree[size + i] = {values[i], i};
+        }
+        for (int node = size - 1; node > 0; --node) {
+            tree[node] = better(tree[2 * node], tree[2 * node + 1]);
+        }
+    }
+    
+    void update(int index, double value) {
+        int node = index + size;
+        tree[node].first = value;
+        for (node /= 2; node > 0; node /= 2) {
+            tree[node] = better(tree[2 * node], tree[2 * node + 1]);
+        }
+    }
+    
+    // Max over the inclusive range [first, last].
+    std::pair<double, int> query(int first, int last) const {
+        std::pair<double, int> result{-std::numeric_limits<double>::infinity(), -1};
+        for (int lo = first + size, hi = last + size + 1; lo < hi; lo /= 2, hi /= 2) {
+            if (lo & 1) result = better(result, tree[lo++]);
+            if (hi & 1) result = better(result, tree[--hi]);
+        }
+        return result;
+    }
+};
+
+// Q-values in one flat allocation. Row s holds actions 0..N-s (triangular)
+// or 0..N (full), padded to whole cache lines so every row starts aligned.
+template <typename Real>
+class QValueTable {
+private:
+    AlignedVector<Real> values;
+    std::vector<size_t> offsets;
+
+public:
+    void assign(int maxInventory, bool triangular) {
+        constexpr size_t lane = 64 / sizeof(Real);
+        offsets.resize(maxInventory + 2);
+        offsets[0] = 0;
+        for (int state = 0; state <= maxInventory; ++state) {
+            size_t length = triangular ? maxInventory - state + 1 : maxInventory + 1;
+            offsets[state + 1] = offsets[state] + (length + lane - 1) / lane * lane;
+        }
+        values.assign(offsets.back(), 0);
+    }
+    
+    void clear() {
+        AlignedVector<Real>().swap(values);
+        offsets.clear();
+    }
+    
+    bool empty() const { return offsets.empty(); }
+    size_t bytes() const { return values.size() * sizeof(Real); }
+    
+    Real* row(int state) { return values.data() + offsets[state]; }
+    const Real* row(int state) const { return values.data() + offsets[state]; }
+};
+
+enum class BackupMode {
+    Standard,
+    PostDecision
+};
+
+// Update order for the standard backup. Gauss-Seidel schedules update in
+// place and always run on one thread; Jacobi and red-black (Jacobi within
+// each parity class, Gauss-Seidel between them) use the thread pool. The
+// post-decision backup is inherently Jacobi and ignores this setting.
+enum class SweepSchedule {
+    Jacobi,
+    GaussSeidelAscending,
+    GaussSeidelDescending,
+    RedBlack
+};
+
+inline const char* sweepScheduleName(SweepSchedule schedule) {
+    switch (schedule) {
+        case SweepSchedule::Jacobi: return "jacobi";
+        case SweepSchedule::GaussSeidelAscending: return "gauss-seidel-ascending";
+        case SweepSchedule::GaussSeidelDescending: return "gauss-seidel-descending";
+        case SweepSchedule::RedBlack: return "red-black";
+    }
+    return "unknown";
+}
+
+enum class PolicyEvaluation {
+    Auto,
+    Direct,
+    Krylov
+};
+
+// SupNorm stops when ||V_k+1 - V_k|| < epsilon. Span stops when the
+// certified optimality gap (see ConvergenceInfo) drops below epsilon.
+enum class StoppingRule {
+    SupNorm,
+    Span
+};
+
+// Parameters of one inventory problem, for constructing and reconfiguring
+// engines.
+struct MDPConfig {
+    int maxInventory = 100;
+    double orderCost = 50.0;
+    double holdingCost = 2.0;
+    double stockoutCost = 20.0;
+    double sellingPrice = 15.0;
+    double demandMean = 10.0;
+    double demandStd = 3.0;
+    double gamma = 0.95;
+    
+    bool operator==(const MDPConfig& other) const {
+        return maxInventory == other.maxInventory && orderCost == other.orderCost &&
+               holdingCost == other.holdingCost && stockoutCost == other.stockoutCost &&
+               sellingPrice == other.sellingPrice && demandMean == other.demandMean &&
+               demandStd == other.demandStd && gamma == other.gamma;
+    }
+    
+    bool operator!=(const MDPConfig& other) const {
+        return !(*this == other);
+    }
+    
+    // Canonical 64-bit key: the fields in declaration order, each as a
+    // 64-bit word (doubles by bit pattern, with -0 folded into +0), through
+    // FNV-1a and a final avalanche. Equal configs always hash alike,
+    // whatever the build or platform byte order.
+    uint64_t hash() const {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        auto mix = [&](uint64_t word) {
+            for (int byte = 0; byte < 8; ++byte) {
+                h ^= (word >> (8 * byte)) & 0xff;
+                h *= 0x100000001b3ULL;
+            }
+        };
+        auto bits = [](double value) {
+            if (value == 0.0) value = 0.0;
+            uint64_t word;
+            std::memcpy(&word, &value, sizeof(word));
+            return word;
+        };
+        mix(static_cast<uint64_t>(static_cast<int64_t>(maxInventory)));
+        for (double field : {orderCost, holdingCost, stockoutCost, sellingPrice, demandMean, demandStd, gamma}) {
+            mix(bits(field));
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h;
+    }
+};
+
+// Where bellmanUpdate leaves its Q-values. None scores each row in a
+// per-thread scratch buffer and keeps nothing, so memory stays O(N).
+// Triangular keeps the (N+1)(N+2)/2 feasible pairs; Full keeps (N+1)^2.
+enum class QStorage {
+    None,
+    Triangular,
+    Full
+};
+
+struct SolverOptions {
+    BackupMode backup = BackupMode::Standard;
+    SweepSchedule schedule = SweepSchedule::GaussSeidelAscending;
+    KernelIsa isa = KernelIsa::Auto;
+    // Threads for chunked sweeps. Standard backups only split under the
+    // Jacobi and RedBlack schedules; the Gauss-Seidel schedules, the default
+    // included, stay sequential. Policy-evaluation sweeps and the generic
+    // post-decision continuation split under any schedule.
+    int numThreads = 1;
+    PolicyEvaluation evaluation = PolicyEvaluation::Auto;
+    bool structuralPruning = false;
+    int pruningWindow = 8;
+    StoppingRule stopping = StoppingRule::SupNorm;
+    bool extrapolate = false;
+    bool actionElimination = false;
+    int andersonDepth = 0;
+    double relaxation = 1.0;
+    // Run most value-iteration sweeps in float, then polish in double.
+    bool mixedPrecision = false;
+    // Build post-decision continuation tables with the fixed-size kernels.
+    bool fixedSizeKernels = true;
+    QStorage qStorage = QStorage::None;
+    // Sweeps between checkpoints of valueIteration; 0 turns them off.
+    int checkpointInterval = 0;
+    std::string checkpointPath;
+};
+
+struct ConvergenceInfo {
+    bool converged = false;
+    int iterations = 0;
+    double finalDelta = 0.0;
+    std::vector<double> deltaHistory;
+    long long backups = 0;
+    bool pruningFallback = false;
+    int fullScanSweeps = 0;
+    // V*(s) lies in [V(s) + lowerBoundShift, V(s) + upperBoundShift] for the
+    // returned V. After a Jacobi-type sweep these are the MacQueen bounds;
+    // the greedy policy is then within optimalityGap of optimal in every
+    // state. Gauss-Seidel sweeps only give the symmetric contraction bound.
+    double lowerBoundShift = -std::numeric_limits<double>::infinity();
+    double upperBoundShift = std::numeric_limits<double>::infinity();
+    double optimalityGap = std::numeric_limits<double>::infinity();
+    std::vector<double> gapHistory;
+    long long eliminatedActions = 0;
+    int acceleratorFallbacks = 0;
+    int singlePrecisionSweeps = 0;
+    // State backups of the reconfigure() warm start that preceded this run,
+    // already included in backups. Its greedy sweep is also counted in
+    // iterations and deltaHistory.
+    long long warmStartBackups = 0;
+};
+
+// Solved policy and value function of one configuration. epsilon is the
+// tolerance it was solved to, under the given stopping rule; extrapolated
+// marks V shifted to the midpoint of the MacQueen bounds.
+struct CachedPolicy {
+    MDPConfig config;
+    double epsilon;
+    StoppingRule stopping = StoppingRule::SupNorm;
+    bool extrapolated = false;
+    int reorderPoint;
+    int orderUpTo;
+    std::vector<int> policy;
+    std::vector<double> values;
+};
+
+// Binary policy pack, version 1, in native byte order:
+//
+//   PolicyPackHeader                       64 bytes
+//   PolicyPackIndexEntry[count]            sorted by config hash
+//   per policy, at 64-byte alignment:
+//     PolicyPackRecord                     128 bytes
+//     double values[N + 1]                 64-byte aligned
+//     int32  policy[N + 1]                 64-byte aligned
+//
+// Offsets are from the start of the file, except the array offsets inside a
+// record, which are from the record. The header and index carry checksums
+// that are checked on open; each record has its own, checked on demand,
+// so opening costs O(count) and never touches the arrays.
+struct PolicyPackHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t count;
+    uint64_t indexOffset;
+    uint64_t fileBytes;
+    uint64_t indexChecksum;
+    uint64_t reserved;
+    uint64_t headerChecksum;
+};
+
+struct PolicyPackIndexEntry {
+    uint64_t hash;
+    uint64_t offset;
+    uint64_t bytes;
+    uint64_t checksum;
+};
+
+struct PolicyPackRecord {
+    int32_t maxInventory;
+    int32_t reorderPoint;
+    int32_t orderUpTo;
+    // Bit 0: Span stopping rule; bit 1: extrapolated V. Zero for defaults.
+    uint32_t solverFlags;
+    double orderCost;
+    double holdingCost;
+    double stockoutCost;
+    double sellingPrice;
+    double demandMean;
+    double demandStd;
+    double gamma;
+    double epsilon;
+    uint64_t valuesOffset;
+    uint64_t policyOffset;
+    uint64_t reserved[4];
+};
+
+static_assert(sizeof(PolicyPackHeader) == 64, "pack header layout");
+static_assert(sizeof(PolicyPackIndexEntry) == 32, "pack index layout");
+static_assert(sizeof(PolicyPackRecord) == 128, "pack record layout");
+
+struct PolicyPackFormat {
+    static constexpr char Magic[8] = {'M', 'D', 'P', 'P', 'A', 'C', 'K', '\0'};
+    static constexpr uint32_t Version = 1;
+    static constexpr uint32_t ByteOrder = 0x01020304;
+    static constexpr uint64_t Alignment = 64;
+    
+    static uint64_t align(uint64_t offset) {
+        return (offset + Alignment - 1) / Alignment * Alignment;
+    }
+    
+    // FNV-1a over raw bytes.
+    static uint64_t checksum(const void* data, size_t bytes) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (size_t i = 0; i < bytes; ++i) {
+            h ^= p[i];
+            h *= 0x100000001b3ULL;
+        }
+        return h;
+    }
+    
+    static uint32_t solverFlags(StoppingRule stopping, bool extrapolated) {
+        return (stopping == StoppingRule::Span ? 1u : 0u) | (extrapolated ? 2u : 0u);
+    }
+    
+    static uint64_t recordBytes(int maxInventory) {
+        uint64_t states = static_cast<uint64_t>(maxInventory) + 1;
+        uint64_t values = align(sizeof(PolicyPackRecord));
+        uint64_t policy = align(values + states * sizeof(double));
+        return align(policy + states * sizeof(int32_t));
+    }
+};
+
+// Read-only view of one policy inside a mapped pack. Cheap to copy; valid
+// while its PolicyPack is open. A default-constructed view is empty.
+class PolicyView {
+private:
+    const PolicyPackRecord* record = nullptr;
+    const PolicyPackIndexEntry* entry = nullptr;
+
+public:
+    PolicyView() = default;
+    PolicyView(const PolicyPackRecord* packRecord, const PolicyPackIndexEntry* indexEntry)
+        : record(packRecord), entry(indexEntry) {}
+    
+    explicit operator bool() const { return record != nullptr; }
+    
+    int maxInventory() const { return record->maxInventory; }
+    int reorderPoint() const { return record->reorderPoint; }
+    int orderUpTo() const { return record->orderUpTo; }
+    double epsilon() const { return record->epsilon; }
+    StoppingRule stopping() const { return (record->solverFlags & 1u) ? StoppingRule::Span : StoppingRule::SupNorm; }
+    bool extrapolated() const { return (record->solverFlags & 2u) != 0; }
+    
+    const double* values() const {
+        return reinterpret_cast<const double*>(reinterpret_cast<const char*>(record) + record->valuesOffset);
+    }
+    
+    const int32_t* policy() const {
+        return reinterpret_cast<const int32_t*>(reinterpret_cast<const char*>(record) + record->policyOffset);
+    }
+    
+    double value(int state) const { return values()[state]; }
+    int action(int state) const { return policy()[state]; }
+    
+    MDPConfig config() const {
+        return {record->maxInventory, record->orderCost, record->holdingCost, record->stockoutCost,
+                record->sellingPrice, record->demandMean, record->demandStd, record->gamma};
+    }
+    
+    // Recomputes the record checksum.
+    bool verify() const {
+        return PolicyPackFormat::checksum(record, entry->bytes) == entry->checksum;
+    }
+};
+
+// A policy pack opened in place: mmap'd where available, otherwise read
+// into one aligned buffer. open() checks the header, the index checksum
+// and every index entry's bounds, then serves lookups by binary search on
+// the config hash without copying or parsing the arrays. Records are not
+// touched until looked up; PolicyView::verify() checks one against its
+// checksum.
+class PolicyPack {
+private:
+    const unsigned char* base = nullptr;
+    size_t bytes = 0;
+    bool mapped = false;
+    AlignedVector<unsigned char> buffer;
+    const PolicyPackHeader* header = nullptr;
+    const PolicyPackIndexEntry* index = nullptr;
+    
+    PolicyPack() = default;
+    
+    bool validate(const std::string& filename) {
+        auto fail = [&](const char* reason) {
+            std::cerr << "Invalid policy pack " << filename << ": " << reason << std::endl;
+            return false;
+        };
+        if (bytes < sizeof(PolicyPackHeader)) return fail("truncated header");
+        header = reinterpret_cast<const PolicyPackHeader*>(base);
+        if (std::memcmp(header->magic, PolicyPackFormat::Magic, sizeof(header->magic)) != 0) {
+            return fail("bad magic");
+        }
+        if (header->version != PolicyPackFormat::Version) return fail("unsupported version");
+        if (header->byteOrder != PolicyPackFormat::ByteOrder) return fail("foreign byte order");
+        if (PolicyPackFormat::checksum(header, offsetof(PolicyPackHeader, headerChecksum)) != header->headerChecksum) {
+            return fail("header checksum mismatch");
+        }
+        if (header->fileBytes != bytes) return fail("size mismatch");
+        if (header->indexOffset % PolicyPackFormat::Alignment != 0 || header->indexOffset > bytes ||
+            header->count > (bytes - header->indexOffset) / sizeof(PolicyPackIndexEntry)) {
+            return fail("index out of bounds");
+        }
+        index = reinterpret_cast<const PolicyPackIndexEntry*>(base + header->indexOffset);
+        if (PolicyPackFormat::checksum(index, header->count * sizeof(PolicyPackIndexEntry)) != header->indexChecksum) {
+            return fail("index checksum mismatch");
+        }
+        for (uint64_t i = 0; i < header->count; ++i) {
+            const PolicyPackIndexEntry& entry = index[i];
+            if (entry.offset % PolicyPackFormat::Alignment != 0 || entry.offset > bytes ||
+                entry.bytes > bytes - entry.offset || (i > 0 && index[i - 1].hash > entry.hash)) {
+                return fail("corrupt index entry");
+            }
+        }
+        return true;
+    }
+    
+    // A view of the entry's record once its array offsets and sizes fit in
+    // the entry's byte range; an empty view otherwise. O(1): the arrays
+    // themselves are only checked by PolicyView::verify().
+    PolicyView viewOf(const PolicyPackIndexEntry* entry) const {
+        if (entry->bytes < sizeof(PolicyPackRecord)) return {};
+        const auto* record = reinterpret_cast<const PolicyPackRecord*>(base + entry->offset);
+        if (record->maxInventory < 0) return {};
+        uint64_t states = static_cast<uint64_t>(record->maxInventory) + 1;
+        auto fits = [&](uint64_t offset, uint64_t elementBytes) {
+            return offset >= sizeof(PolicyPackRecord) && offset % elementBytes == 0 && offset <= entry->bytes &&
+                   states <= (entry->bytes - offset) / elementBytes;
+        };
+        if (!fits(record->valuesOffset, sizeof(double)) || !fits(record->policyOffset, sizeof(int32_t))) return {};
+        return {record, entry};
+    }
+
+public:
+    ~PolicyPack() {
+#ifdef MDP_ENGINE_MMAP
+        if (mapped) munmap(const_cast<unsigned char*>(base), bytes);
+#endif
+    }
+    
+    PolicyPack(const PolicyPack&) = delete;
+    PolicyPack& operator=(const PolicyPack&) = delete;
+    
+    // nullptr (with a message on stderr) if the file is missing or invalid.
+    static std::unique_ptr<PolicyPack> open(const std::string& filename) {
+        std::unique_ptr<PolicyPack> pack(new PolicyPack());
+#ifdef MDP_ENGINE_MMAP
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Error opening file: " << filename << std::endl;
+            return nullptr;
+        }
+        struct stat status;
+        if (fstat(fd, &status) == 0 && status.st_size > 0) {
+            pack->bytes = static_cast<size_t>(status.st_size);
+            void* mapping = mmap(nullptr, pack->bytes, PROT_READ, MAP_SHARED, fd, 0);
+            if (mapping != MAP_FAILED) {
+                pack->base = static_cast<const unsigned char*>(mapping);
+                pack->mapped = true;
+            }
+        }
+        ::close(fd);
+#endif
+        if (!pack->mapped) {
+            std::ifstream in(filename, std::ios::binary | std::ios::ate);
+            if (!in.is_open()) {
+                std::cerr << "Error opening file: " << filename << std::endl;
+                return nullptr;
+            }
+            pack->buffer.resize(static_cast<size_t>(in.tellg()));
+            in.seekg(0);
+            in.read(reinterpret_cast<char*>(pack->buffer.data()), pack->buffer.size());
+            pack->base = pack->buffer.data();
+            pack->bytes = pack->buffer.size();
+        }
+        if (!pack->validate(filename)) return nullptr;
+        return pack;
+    }
+    
+    size_t size() const {
+        return static_cast<size_t>(header->count);
+    }
+    
+    // Empty if the record's layout does not fit its index entry.
+    PolicyView at(size_t i) const {
+        return viewOf(&index[i]);
+    }
+    
+    // The policy stored for config, or an empty view.
+    PolicyView find(const MDPConfig& config) const {
+        uint64_t key = config.hash();
+        const PolicyPackIndexEntry* end = index + header->count;
+        auto first = std::lower_bound(index, end, key,
+                                      [](const PolicyPackIndexEntry& entry, uint64_t k) { return entry.hash < k; });
+        for (; first != end && first->hash == key; ++first) {
+            PolicyView view = viewOf(first);
+            if (view && view.config() == config) return view;
+        }
+        return {};
+    }
+};
+
+// Collects solved policies and writes them as one pack. A config added
+// twice keeps its last entry. The file is written under a temporary name
+// and renamed into place.
+class PolicyPackWriter {
+private:
+    std::vector<std::shared_ptr<const CachedPolicy>> entries;
+    
+    static void fillRecord(const CachedPolicy& entry, std::vector<unsigned char>& out) {
+        const MDPConfig& c = entry.config;
+        out.assign(PolicyPackFormat::recordBytes(c.maxInventory), 0);
+        PolicyPackRecord record{};
+        record.maxInventory = c.maxInventory;
+        record.reorderPoint = entry.reorderPoint;
+        record.orderUpTo = entry.orderUpTo;
+        record.solverFlags = PolicyPackFormat::solverFlags(entry.stopping, entry.extrapolated);
+        record.orderCost = c.orderCost;
+        record.holdingCost = c.holdingCost;
+        record.stockoutCost = c.stockoutCost;
+        record.sellingPrice = c.sellingPrice;
+        record.demandMean = c.demandMean;
+        record.demandStd = c.demandStd;
+        record.gamma = c.gamma;
+        record.epsilon = entry.epsilon;
+        record.valuesOffset = PolicyPackFormat::align(sizeof(PolicyPackRecord));
+        record.policyOffset = PolicyPackFormat::align(record.valuesOffset + entry.values.size() * sizeof(double));
+        std::memcpy(out.data(), &record, sizeof(record));
+        std::memcpy(out.data() + record.valuesOffset, entry.values.data(), entry.values.size() * sizeof(double));
+        for (size_t state = 0; state < entry.policy.size(); ++state) {
+            int32_t action = entry.policy[state];
+            std::memcpy(out.data() + record.policyOffset + state * sizeof(int32_t), &action, sizeof(action));
+        }
+    }
+
+public:
+    void add(std::shared_ptr<const CachedPolicy> entry) {
+        entries.push_back(std::move(entry));
+    }
+    
+    size_t size() const {
+        return entries.size();
+    }
+    
+    bool write(const std::string& filename) const {
+        std::vector<std::pair<uint64_t, size_t>> order;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            order.push_back({entries[i]->config.hash(), i});
+        }
+        // Stable by hash, then the last duplicate of each config wins.
+        std::stable_sort(order.begin(), order.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+        std::vector<size_t> kept;
+        for (size_t i = 0; i < order.size(); ++i) {
+            bool superseded = false;
+            for (size_t j = i + 1; j < order.size() && order[j].first == order[i].first; ++j) {
+                superseded = superseded || entries[order[j].second]->config == entries[order[i].second]->config;
+            }
+            if (!superseded) kept.push_back(order[i].second);
+        }
+        
+        PolicyPackHeader header{};
+        std::memcpy(header.magic, PolicyPackFormat::Magic, sizeof(header.magic));
+        header.version = PolicyPackFormat::Version;
+        header.byteOrder = PolicyPackFormat::ByteOrder;
+        header.count = kept.size();
+        header.indexOffset = PolicyPackFormat::align(sizeof(PolicyPackHeader));
+        
+        std::vector<PolicyPackIndexEntry> index(kept.size());
+        std::vector<unsigned char> record;
+        uint64_t offset = PolicyPackFormat::align(header.indexOffset + kept.size() * sizeof(PolicyPackIndexEntry));
+        for (size_t i = 0; i < kept.size(); ++i) {
+            fillRecord(*entries[kept[i]], record);
+            index[i] = {entries[kept[i]]->config.hash(), offset, record.size(),
+                        PolicyPackFormat::checksum(record.data(), record.size())};
+            offset += record.size();
+        }
+        header.fileBytes = offset;
+        header.indexChecksum = PolicyPackFormat::checksum(index.data(), index.size() * sizeof(PolicyPackIndexEntry));
+        header.headerChecksum = PolicyPackFormat::checksum(&header, offsetof(PolicyPackHeader, headerChecksum));
+        
+        std::string temporary = filename + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary);
+            if (!out.is_open()) {
+                std::cerr << "Error opening file: " << temporary << std::endl;
+                return false;
+            }
+            std::vector<char> padding(PolicyPackFormat::Alignment, 0);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(padding.data(), header.indexOffset - sizeof(header));
+            out.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(PolicyPackIndexEntry));
+            uint64_t written = header.indexOffset + index.size() * sizeof(PolicyPackIndexEntry);
+            out.write(padding.data(), PolicyPackFormat::align(written) - written);
+            for (size_t i = 0; i < kept.size(); ++i) {
+                fillRecord(*entries[kept[i]], record);
+                out.write(reinterpret_cast<const char*>(record.data()), record.size());
+            }
+            if (!out) {
+                std::cerr << "Error writing file: " << temporary << std::endl;
+                std::remove(temporary.c_str());
+                return false;
+            }
+        }
+        if (std::rename(temporary.c_str(), filename.c_str()) != 0) {
+            std::cerr << "Error renaming " << temporary << " to " << filename << std::endl;
+            std::remove(temporary.c_str());
+            return false;
+        }
+        return true;
+    }
+};
+
+// Resumable state of a value-iteration run.
+struct SolverCheckpoint {
+    MDPConfig config;
+    int iterations = 0;
+    std::vector<double> values;
+    std::vector<int> policy;
+    std::vector<double> deltaHistory;
+};
+
+// Checkpoint file, version 1, in native byte order: a 64-byte header, then
+// the config (maxInventory as int64, the seven doubles), the values, the
+// policy as int32 and the delta history. The header holds the config hash
+// and a checksum of everything after it. Files are written under a
+// temporary name and renamed into place, so the path always holds the
+// last complete checkpoint.
+struct CheckpointFile {
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t configHash;
+        int64_t iterations;
+        uint64_t states;
+        uint64_t historyLength;
+        uint64_t payloadChecksum;
+        uint64_t headerChecksum;
+    };
+    static_assert(sizeof(Header) == 64, "checkpoint header layout");
+    
+    static constexpr char Magic[8] = {'M', 'D', 'P', 'C', 'K', 'P', 'T', '\0'};
+    static constexpr uint32_t Version = 1;
+    
+    template <typename T>
+    static void append(std::vector<unsigned char>& out, const T* data, size_t count) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        out.insert(out.end(), bytes, bytes + count * sizeof(T));
+    }
+    
+    static bool write(const std::string& filename, const SolverCheckpoint& checkpoint) {
+        const MDPConfig& c = checkpoint.config;
+        std::vector<unsigned char> payload;
+        int64_t maxInventory = c.maxInventory;
+        append(payload, &maxInventory, 1);
+        for (double field : {c.orderCost, c.holdingCost, c.stockoutCost, c.sellingPrice, c.demandMean, c.demandStd, c.gamma}) {
+            append(payload, &field, 1);
+        }
+        append(payload, checkpoint.values.data(), checkpoint.values.size());
+        std::vector<int32_t> policy(checkpoint.policy.begin(), checkpoint.policy.end());
+        append(payload, policy.data(), policy.size());
+        append(payload, checkpoint.deltaHistory.data(), checkpoint.deltaHistory.size());
+        
+        Header header{};
+        std::memcpy(header.magic, Magic, sizeof(header.magic));
+        header.version = Version;
+        header.byteOrder = PolicyPackFormat::ByteOrder;
+        header.configHash = c.hash();
+        header.iterations = checkpoint.iterations;
+        header.states = checkpoint.values.size();
+        header.historyLength = checkpoint.deltaHistory.size();
+        header.payloadChecksum = PolicyPackFormat::checksum(payload.data(), payload.size());
+        header.headerChecksum = PolicyPackFormat::checksum(&header, offsetof(Header, headerChecksum));
+        
+        std::string temporary = filename + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary);
+            if (!out.is_open()) {
+                std::cerr << "Error opening file: " << temporary << std::endl;
+                return false;
+            }
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+            if (!out) {
+                std::cerr << "Error writing file: " << temporary << std::endl;
+                std::remove(temporary.c_str());
+                return false;
+            }
+        }
+        if (std::rename(temporary.c_str(), filename.c_str()) != 0) {
+            std::cerr << "Error renaming " << temporary << " to " << filename << std::endl;
+            std::remove(temporary.c_str());
+            return false;
+        }
+        return true;
+    }
+    
+    static bool read(const std::string& filename, SolverCheckpoint& checkpoint) {
+        std::ifstream in(filename, std::ios::binary | std::ios::ate);
+        if (!in.is_open()) {
+            std::cerr << "Error opening file: " << filename << std::endl;
+            return false;
+        }
+        std::vector<unsigned char> bytes(static_cast<size_t>(in.tellg()));
+        in.seekg(0);
+        in.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+        
+        auto fail = [&](const char* reason) {
+            std::cerr << "Invalid checkpoint " << filename << ": " << reason << std::endl;
+            return false;
+        };
+        if (!in || bytes.size() < sizeof(Header)) return fail("truncated header");
+        Header header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0) return fail("bad magic");
+        if (header.version != Version) return fail("unsupported version");
+        if (header.byteOrder != PolicyPackFormat::ByteOrder) return fail("foreign byte order");
+        if (PolicyPackFormat::checksum(&header, offsetof(Header, headerChecksum)) != header.headerChecksum) {
+            return fail("header checksum mismatch");
+        }
+        size_t payloadBytes = bytes.size() - sizeof(Header);
+        const unsigned char* payload = bytes.data() + sizeof(Header);
+        if (header.states > payloadBytes || header.historyLength > payloadBytes ||
+            payloadBytes != 64 + header.states * (sizeof(double) + sizeof(int32_t)) + header.historyLength * sizeof(double)) {
+            return fail("size mismatch");
+        }
+        if (PolicyPackFormat::checksum(payload, payloadBytes) != header.payloadChecksum) {
+            return fail("payload checksum mismatch");
+        }
+        
+        MDPConfig& c = checkpoint.config;
+        int64_t maxInventory;
+        std::memcpy(&maxInventory, payload, sizeof(maxInventory));
+        c.maxInventory = static_cast<int>(maxInventory);
+        size_t offset = sizeof(int64_t);
+        for (double* field : {&c.orderCost, &c.holdingCost, &c.stockoutCost, &c.sellingPrice, &c.demandMean,
+                              &c.demandStd, &c.gamma}) {
+            std::memcpy(field, payload + offset, sizeof(double));
+            offset += sizeof(double);
+        }
+        if (c.hash() != header.configHash || header.states != static_cast<uint64_t>(c.maxInventory) + 1) {
+            return fail("config does not match its hash");
+        }
+        
+        checkpoint.iterations = static_cast<int>(header.iterations);
+        checkpoint.values.resize(header.states);
+        std::memcpy(checkpoint.values.data(), payload + offset, header.states * sizeof(double));
+        offset += header.states * sizeof(double);
+        std::vector<int32_t> policy(header.states);
+        std::memcpy(policy.data(), payload + offset, header.states * sizeof(int32_t));
+        offset += header.states * sizeof(int32_t);
+        checkpoint.policy.assign(policy.begin(), policy.end());
+        checkpoint.deltaHistory.resize(header.historyLength);
+        std::memcpy(checkpoint.deltaHistory.data(), payload + offset, header.historyLength * sizeof(double));
+        return true;
+    }
+};
+
+// Writes checkpoints on a background thread so the sweep loop only pays for
+// copying its state. A single slot holds the next checkpoint: one submitted
+// while the previous write is still running replaces any older one still
+// waiting, so a slow disk drops intermediate checkpoints rather than the
+// solver stalling. flush() and the destructor wait for the slot to drain.
+class CheckpointWriter {
+private:
+    std::string filename;
+    std::mutex mutex;
+    std::condition_variable changed;
+    SolverCheckpoint pending;
+    bool hasPending = false;
+    bool writing = false;
+    bool stopping = false;
+    std::atomic<int> written{0};
+    // Last, so the state workerLoop() uses exists before the thread starts.
+    std::thread worker;
+    
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            changed.wait(lock, [&] { return stopping || hasPending; });
+            if (!hasPending) return;
+            SolverCheckpoint checkpoint = std::move(pending);
+            hasPending = false;
+            writing = true;
+            lock.unlock();
+            if (CheckpointFile::write(filename, checkpoint)) written.fetch_add(1);
+            lock.lock();
+            writing = false;
+            changed.notify_all();
+        }
+    }
+
+public:
+    explicit CheckpointWriter(std::string path)
+        : filename(std::move(path)), worker([this] { workerLoop(); }) {}
+    
+    ~CheckpointWriter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        changed.notify_all();
+        worker.join();
+    }
+    
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+    
+    const std::string& path() const {
+        return filename;
+    }
+    
+    int checkpointsWritten() const {
+        return written.load();
+    }
+    
+    void submit(SolverCheckpoint checkpoint) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending = std::move(checkpoint);
+            hasPending = true;
+        }
+        changed.notify_all();
+    }
+    
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return !hasPending && !writing; });
+    }
+};
+
+// Value type Real is double or float. Model parameters, rewards and the
+// demand tables stay in double; the value function, Q rows and the operands
+// of the vector kernels use Real, which halves their memory traffic in float.
+template <typename Real>
+class BasicMDPEngine {
+    template <typename> friend class BasicMDPEngine;
+    
+private:
+    int maxInventory;
+    double orderCost;
+    double holdingCost;
+    double stockoutCost;
+    double sellingPrice;
+    double demandMean;
+    double demandStd;
+    double gamma;
+    
+    std::vector<Real> valueFunction;
+    std::vector<int> policy;
+    QValueTable<Real> qValues;
+    
+    std::random_device rd;
+    std::mt19937 gen;
+    std::shared_ptr<const DemandDistribution> demandModel;
+    
+    struct TransportMode {
+        double cost;
+        int time;
+        // Probability of arriving on time, as in schema.sql.
+        double reliability;
+    };
+    
+    std::map<std::string, TransportMode> transportModes;
+
+public:
+    using BackupMode = ::BackupMode;
+    using SweepSchedule = ::SweepSchedule;
+    using PolicyEvaluation = ::PolicyEvaluation;
+    using StoppingRule = ::StoppingRule;
+    using SolverOptions = ::SolverOptions;
+    using ConvergenceInfo = ::ConvergenceInfo;
+    using QStorage = ::QStorage;
+    
+    static const char* sweepScheduleName(SweepSchedule schedule) {
+        return ::sweepScheduleName(schedule);
+    }
+
+private:
+    SolverOptions options;
+    const BellmanKernels<Real>* kernels;
+    const typename ContinuationKernels<Real>::Entry* continuationKernel = nullptr;
+    std::unique_ptr<ThreadPool> pool;
+    ParallelExecutor* executor = nullptr;
+    std::vector<Real> nextValues;
+    std::vector<double> chunkDeltas;
+    std::vector<Real> previousValues;
+    std::vector<std::vector<int>> activeActions;
+    double eliminationMargin = std::numeric_limits<double>::infinity();
+    std::vector<std::vector<Real>> andersonIterateSteps;
+    std::vector<std::vector<Real>> andersonResidualSteps;
+    std::vector<Real> andersonIterate;
+    std::vector<Real> andersonResidual;
+    double acceleratorResidual = std::numeric_limits<double>::infinity();
+    // Checkpoints of valueIteration, and the run state loaded by
+    // resumeFromCheckpoint() for the next valueIteration to continue.
+    std::unique_ptr<CheckpointWriter> checkpointWriter;
+    int resumedIterations = 0;
+    std::vector<double> resumedHistory;
+    long long warmStartBackups = 0;
+    // Float engine of mixedPrecisionValueIteration, built on first use.
+    std::unique_ptr<BasicMDPEngine<float>> singlePrecisionEngine;
+    bool pruningActive = false;
+    const int* pruningHints = nullptr;
+    std::vector<int> hintPolicy;
+    std::vector<Real> postDecisionValues;
+    std::vector<double> expectedRevenue;
+    std::vector<double> expectedShortage;
+    std::vector<double> stateRewards;
+
+public:
+    BasicMDPEngine(int maxInv, double ordCost, double holdCost, double stockCost, 
+              double sellPrice, double demMean, double demStd, double discountFactor)
+        : maxInventory(maxInv), orderCost(ordCost), holdingCost(holdCost),
+          stockoutCost(stockCost), sellingPrice(sellPrice), demandMean(demMean),
+          demandStd(demStd), gamma(discountFactor), gen(rd()), 
+          demandModel(std::make_shared<const DemandDistribution>(demandMean, demandStd)),
+          kernels(&BellmanKernels<Real>::select(options.isa)) {
+        
+        valueFunction.resize(maxInventory + 1, 0.0);
+        policy.resize(maxInventory + 1, 0);
+        postDecisionValues.resize(maxInventory + 1, 0.0);
+        buildRewardTables();
+        continuationKernel = ContinuationKernels<Real>::select(maxInventory + 1, demandModel->support());
+        
+        transportModes["truck"] = {100.0, 1, 0.95};
+        transportModes["ship"] = {50.0, 3, 0.90};
+        transportModes["rail"] = {75.0, 2, 0.92};
+        transportModes["air"] = {200.0, 0, 0.98};
+    }
+    
+    explicit BasicMDPEngine(const MDPConfig& config)
+        : BasicMDPEngine(config.maxInventory, config.orderCost, config.holdingCost, config.stockoutCost,
+                         config.sellingPrice, config.demandMean, config.demandStd, config.gamma) {}
+    
+    MDPConfig config() const {
+        return {maxInventory, orderCost, holdingCost, stockoutCost, sellingPrice, demandMean, demandStd, gamma};
+    }
+    
+    // Switches to new parameters but keeps V and the policy as the starting
+    // point of the next solve. The demand tables are rebuilt only if the mean
+    // or std changed; a matching table passed in is shared instead. A new
+    // maxInventory truncates V or extends it with its top value. Eliminated
+    // actions are restored, since the elimination test held only for the old
+    // parameters.
+    //
+    // A parameter change mostly moves V* by an amount value iteration removes
+    // only at rate beta. So the start point is one policy-iteration step: the
+    // greedy policy for the old V under the new parameters, evaluated exactly.
+    // Re-centring V by mid(TV - V) / (1 - beta) is not enough, since changes
+    // such as the stockout cost only touch the rarely visited low states.
+    void reconfigure(const MDPConfig& config, std::shared_ptr<const DemandDistribution> demand = nullptr) {
+        applyConfig(config, std::move(demand));
+        
+        // The warm start is charged to the next valueIteration: its greedy
+        // sweep as the run's first iteration, the evaluation as backups.
+        nextValues.resize(maxInventory + 1);
+        hintPolicy.resize(maxInventory + 1);
+        double delta = postDecisionBackup(valueFunction.data(), nextValues.data(), hintPolicy.data());
+        policy = hintPolicy;
+        int passes = evaluatePolicy(options.evaluation);
+        resumedIterations = 1;
+        resumedHistory.assign(1, delta);
+        warmStartBackups = static_cast<long long>(1 + passes) * (maxInventory + 1);
+    }
+    
+    // The parameter switch of reconfigure(), without the warm start.
+    void applyConfig(const MDPConfig& config, std::shared_ptr<const DemandDistribution> demand) {
+        orderCost = config.orderCost;
+        holdingCost = config.holdingCost;
+        stockoutCost = config.stockoutCost;
+        sellingPrice = config.sellingPrice;
+        gamma = config.gamma;
+        
+        demandMean = config.demandMean;
+        demandStd = config.demandStd;
+        if (demand && demand->matches(demandMean, demandStd)) {
+            demandModel = std::move(demand);
+        } else if (!demandModel->matches(demandMean, demandStd)) {
+            demandModel = std::make_shared<const DemandDistribution>(demandMean, demandStd);
+        }
+        
+        if (config.maxInventory != maxInventory) {
+            maxInventory = config.maxInventory;
+            valueFunction.resize(maxInventory + 1, valueFunction.back());
+            policy.resize(maxInventory + 1, 0);
+            for (int state = 0; state <= maxInventory; ++state) {
+                policy[state] = std::min(policy[state], maxInventory - state);
+            }
+            postDecisionValues.resize(maxInventory + 1, 0);
+            if (!qValues.empty()) qValues.assign(maxInventory, options.qStorage == QStorage::Triangular);
+        }
+        
+        buildRewardTables();
+        continuationKernel = ContinuationKernels<Real>::select(maxInventory + 1, demandModel->support());
+        activeActions.assign(options.actionElimination ? maxInventory + 1 : 0, std::vector<int>());
+        resetAccelerator();
+    }
+    
+    double normalPDF(double x, double mean, double std) {
+        return DemandDistribution::normalPDF(x, mean, std);
+    }
+    
+    double demandProbability(int d) {
+        return demandModel->probability(d);
+    }
+    
+    std::shared_ptr<const DemandDistribution> demandDistribution() const {
+        return demandModel;
+    }
+    
+    double stateValue(int state) const {
+        return valueFunction[state];
+    }
+    
+    int action(int state) const {
+        return policy[state];
+    }
+    
+    // Transit time in periods and fixed cost per order of a transport mode.
+    // Unknown modes arrive at once and cost nothing, as in simulateEpisode.
+    int transportTime(const std::string& mode) const {
+        auto found = transportModes.find(mode);
+        return (found != transportModes.end()) ? found->second.time : 0;
+    }
+    
+    double transportCost(const std::string& mode) const {
+        auto found = transportModes.find(mode);
+        return (found != transportModes.end()) ? found->second.cost : 0.0;
+    }
+    
+    double transportReliability(const std::string& mode) const {
+        auto found = transportModes.find(mode);
+        return (found != transportModes.end()) ? found->second.reliability : 1.0;
+    }
+    
+    // R(s) = E[p min(s, D) - h s - b (D - s)^+], weighted by the same PMF as the backup.
+    void buildRewardTables() {
+        double probabilityMass = demandModel->totalMass();
+        
+        expectedRevenue.resize(maxInventory + 1);
+        expectedShortage.resize(maxInventory + 1);
+        stateRewards.resize(maxInventory + 1);
+        
+        for (int state = 0; state <= maxInventory; ++state) {
+            expectedRevenue[state] = sellingPrice * demandModel->expectedSales(state);
+            expectedShortage[state] = demandModel->expectedShortage(state);
+            stateRewards[state] = expectedRevenue[state] - holdingCost * state * probabilityMass -
+                                  stockoutCost * expectedShortage[state];
+        }
+    }
+    
+    double expectedOrderingCost(int action) const {
+        return (action > 0) ? demandModel->totalMass() * (orderCost + action * 5.0) : 0.0;
+    }
+    
+    double immediateReward(int state, int action, int demand) {
+        int sales = std::min(state, demand);
+        double revenue = sales * sellingPrice;
+        double holding = state * holdingCost;
+        double ordering = (action > 0) ? (orderCost + action * 5.0) : 0.0;
+        double stockout = std::max(0, demand - state) * stockoutCost;
+        return revenue - holding - ordering - stockout;
+    }
+    
+    // E[V(max(0, y - D))]: the interior d <= y is a dot product over the contiguous
+    // slice V[y - d], and demand above y all lands on V[0].
+    double continuationValue(const Real* values, int level) const {
+        int maxDemand = demandModel->maxValue();
+        int interior = std::min(level, maxDemand);
+        double expected = kernels->dot(demandModel->reversedPmfAs<Real>() + (maxDemand - interior),
+                                       values + (level - interior), interior + 1);
+        if (level < maxDemand) {
+            expected += demandModel->tailMass(level) * values[0];
+        }
+        return expected;
+    }
+    
+    // Row that bellmanUpdate scores state's actions into: the stored row, or a
+    // scratch row private to the calling thread when Q is not stored.
+    Real* qRow(int state) {
+        if (!qValues.empty()) return qValues.row(state);
+        static thread_local AlignedVector<Real> scratch;
+        if (scratch.size() < static_cast<size_t>(maxInventory + 1)) scratch.resize(maxInventory + 1);
+        return scratch.data();
+    }
+    
+    // Q(s, a) as of the last backup of s when Q is stored (actions skipped by
+    // pruning or elimination keep older values); otherwise recomputed from
+    // the current V.
+    double qValue(int state, int action) const {
+        if (!qValues.empty()) return qValues.row(state)[action];
+        return stateRewards[state] - expectedOrderingCost(action) +
+               gamma * continuationValue(valueFunction.data(), state + action);
+    }
+    
+    std::pair<double, int> bellmanUpdate(int state) {
+        return bellmanUpdate(state, valueFunction.data());
+    }
+    
+    std::pair<double, int> bellmanUpdate(int state, const Real* values) {
+        if (options.actionElimination && !activeActions.empty() && !activeActions[state].empty()) {
+            return eliminatingBellmanUpdate(state, values);
+        }
+        
+        if (pruningActive && state > 0) {
+            return prunedBellmanUpdate(state, values);
+        }
+        
+        int maxAction = std::min(maxInventory - state, maxInventory);
+        Real* row = qRow(state);
+        
+        for (int action = 0; action <= maxAction; ++action) {
+            row[action] = stateRewards[state] - expectedOrderingCost(action) +
+                          gamma * continuationValue(values, state + action);
+        }
+        
+        int bestAction = kernels->argmax(row, maxAction + 1);
+        
+        // activeActions is sized before the first sweep; parallel sweeps only
+        // touch their own states' entries here.
+        if (options.actionElimination && eliminationMargin < std::numeric_limits<double>::infinity() &&
+            !activeActions.empty()) {
+            double threshold = row[bestAction] - eliminationMargin;
+            for (int action = 0; action <= maxAction; ++action) {
+                if (row[action] >= threshold) activeActions[state].push_back(action);
+            }
+        }
+        
+        return {row[bestAction], bestAction};
+    }
+    
+    // MacQueen's test: with V* - V in [l, u], Q*(s, a) <= Q_V(s, a) + beta u and
+    // V*(s) >= max_a Q_V(s, a) + beta l. An action whose Q_V falls more than
+    // beta (u - l) below the best can never be optimal, so it is dropped for
+    // good. eliminationMargin holds beta (u - l) from the previous sweep.
+    std::pair<double, int> eliminatingBellmanUpdate(int state, const Real* values) {
+        std::vector<int>& actions = activeActions[state];
+        Real* row = qRow(state);
+        double bestValue = -std::numeric_limits<double>::infinity();
+        int bestAction = actions.front();
+        
+        for (int action : actions) {
+            row[action] = stateRewards[state] - expectedOrderingCost(action) +
+                          gamma * continuationValue(values, state + action);
+            if (row[action] > bestValue) {
+                bestValue = row[action];
+                bestAction = action;
+            }
+        }
+        
+        double threshold = bestValue - eliminationMargin;
+        actions.erase(std::remove_if(actions.begin(), actions.end(),
+                                     [&](int action) { return row[action] < threshold; }),
+                      actions.end());
+        
+        return {bestValue, bestAction};
+    }
+    
+    long long countEliminatedActions() const {
+        if (activeActions.empty()) return 0;
+        long long eliminated = 0;
+        for (int state = 0; state <= maxInventory; ++state) {
+            if (!activeActions[state].empty()) {
+                eliminated += (maxInventory - state + 1) - static_cast<long long>(activeActions[state].size());
+            }
+        }
+        return eliminated;
+    }
+    
+    // The optimal order-up-to level is nondecreasing in the state and, by
+    // K-convexity, the order value is unimodal enough that a local search
+    // finds it. So only "no order" and a window of levels around the lower
+    // neighbour's level are scored. The window keeps growing while the best
+    // level sits on its edge. State 0 always gets a full scan to anchor the
+    // chain of hints, and valueIteration verifies the result with full scans.
+    std::pair<double, int> prunedBellmanUpdate(int state, const Real* values) {
+        Real* row = qRow(state);
+        auto score = [&](int action) {
+            row[action] = stateRewards[state] - expectedOrderingCost(action) +
+                          gamma * continuationValue(values, state + action);
+            return row[action];
+        };
+        
+        double bestValue = score(0);
+        int bestAction = 0;
+        if (state == maxInventory) return {bestValue, bestAction};
+        
+        int window = std::max(1, options.pruningWindow);
+        int neighbourAction = pruningHints[state - 1];
+        int center = (neighbourAction > 0) ? std::max(state, state - 1 + neighbourAction) : state;
+        int lo = std::max(state + 1, center - window);
+        int hi = std::min(maxInventory, center + window);
+        
+        auto scan = [&](int first, int last) {
+            for (int level = first; level <= last; ++level) {
+                double value = score(level - state);
+                if (value > bestValue) {
+                    bestValue = value;
+                    bestAction = level - state;
+                }
+            }
+        };
+        
+        scan(lo, hi);
+        while (bestAction == hi - state && hi < maxInventory) {
+            int next = std::min(maxInventory, hi + window);
+            scan(hi + 1, next);
+            hi = next;
+        }
+        while (bestAction == lo - state && lo > state + 1) {
+            int next = std::max(state + 1, lo - window);
+            scan(next, lo - 1);
+            lo = next;
+        }
+        
+        return {bestValue, bestAction};
+    }
+    
+    bool orderLevelsMonotone() const {
+        int previousLevel = -1;
+        for (int state = 0; state <= maxInventory; ++state) {
+            if (policy[state] == 0) continue;
+            int level = state + policy[state];
+            if (level < previousLevel) return false;
+            previousLevel = level;
+        }
+        return true;
+    }
+    
+    void setSolverOptions(const SolverOptions& newOptions) {
+        bool storageChanged = qValues.empty() ? newOptions.qStorage != QStorage::None
+                                              : newOptions.qStorage != options.qStorage;
+        options = newOptions;
+        kernels = &BellmanKernels<Real>::select(options.isa);
+        
+        if (storageChanged) {
+            if (options.qStorage == QStorage::None) {
+                qValues.clear();
+            } else {
+                qValues.assign(maxInventory, options.qStorage == QStorage::Triangular);
+            }
+        }
+        
+        int threads = std::max(1, options.numThreads);
+        if (threads == 1) {
+            pool.reset();
+        } else if (!pool || pool->size() != threads) {
+            pool = std::make_unique<ThreadPool>(threads);
+        }
+    }
+    
+    // Splits [0, count) into contiguous chunks and runs them on the external
+    // executor, else the pool (or inline when single-threaded). Returns the
+    // number of chunks used.
+    int forEachChunk(int count, const std::function<void(int, int, int)>& body) {
+        ParallelExecutor* parallel = executor ? executor : pool.get();
+        int threads = parallel ? parallel->size() : 1;
+        int chunks = std::max(1, std::min(count, threads * 16));
+        int chunkSize = (count + chunks - 1) / chunks;
+        chunks = (count + chunkSize - 1) / chunkSize;
+        
+        auto runChunk = [&](int chunk) {
+            int begin = chunk * chunkSize;
+            body(begin, std::min(count, begin + chunkSize), chunk);
+        };
+        
+        if (parallel) {
+            parallel->run(chunks, runChunk);
+        } else {
+            for (int chunk = 0; chunk < chunks; ++chunk) runChunk(chunk);
+        }
+        return chunks;
+    }
+    
+    double maxChunkDelta(int chunks) const {
+        return *std::max_element(chunkDeltas.begin(), chunkDeltas.begin() + chunks);
+    }
+    
+    // Jacobi sweep: every backup reads the values from the start of the sweep
+    // and writes into the second buffer, so state ranges can run in parallel.
+    double jacobiSweep() {
+        nextValues.resize(valueFunction.size());
+        chunkDeltas.assign(maxInventory + 1, 0.0);
+        const Real* values = valueFunction.data();
+        
+        int chunks = forEachChunk(maxInventory + 1, [&](int begin, int end, int chunk) {
+            double delta = 0.0;
+            for (int state = begin; state < end; ++state) {
+                auto [newValue, bestAction] = bellmanUpdate(state, values);
+                delta = std::max(delta, std::abs(values[state] - newValue));
+                nextValues[state] = newValue;
+                policy[state] = bestAction;
+            }
+            chunkDeltas[chunk] = delta;
+        });
+        
+        valueFunction.swap(nextValues);
+        return maxChunkDelta(chunks);
+    }
+    
+    double gaussSeidelSweep(bool ascending) {
+        double delta = 0.0;
+        
+        for (int i = 0; i <= maxInventory; ++i) {
+            int state = ascending ? i : maxInventory - i;
+            auto [newValue, bestAction] = bellmanUpdate(state);
+            delta = std::max(delta, std::abs(valueFunction[state] - newValue));
+            valueFunction[state] = newValue;
+            policy[state] = bestAction;
+        }
+        
+        return delta;
+    }
+    
+    double redBlackSweep() {
+        nextValues.resize(valueFunction.size());
+        chunkDeltas.assign(maxInventory + 1, 0.0);
+        double delta = 0.0;
+        
+        for (int parity = 0; parity < 2; ++parity) {
+            int count = (maxInventory + 2 - parity) / 2;
+            const Real* values = valueFunction.data();
+            
+            int chunks = forEachChunk(count, [&](int begin, int end, int chunk) {
+                double chunkDelta = 0.0;
+                for (int i = begin; i < end; ++i) {
+                    int state = 2 * i + parity;
+                    auto [newValue, bestAction] = bellmanUpdate(state, values);
+                    chunkDelta = std::max(chunkDelta, std::abs(values[state] - newValue));
+                    nextValues[state] = newValue;
+                    policy[state] = bestAction;
+                }
+                chunkDeltas[chunk] = chunkDelta;
+            });
+            
+            for (int state = parity; state <= maxInventory; state += 2) {
+                valueFunction[state] = nextValues[state];
+            }
+            delta = std::max(delta, maxChunkDelta(chunks));
+        }
+        
+        return delta;
+    }
+    
+    double standardSweep() {
+        if (options.schedule == SweepSchedule::Jacobi || options.schedule == SweepSchedule::RedBlack) {
+            hintPolicy = policy;
+            pruningHints = hintPolicy.data();
+        } else {
+            pruningHints = policy.data();
+        }
+        
+        switch (options.schedule) {
+            case SweepSchedule::Jacobi: return jacobiSweep();
+            case SweepSchedule::GaussSeidelDescending: return gaussSeidelSweep(false);
+            case SweepSchedule::RedBlack: return redBlackSweep();
+            default: return gaussSeidelSweep(true);
+        }
+    }
+    
+    const char* kernelName() const {
+        return kernels->name;
+    }
+    
+    // Bucket used for post-decision continuation tables, {0, 0} if generic.
+    std::pair<int, int> continuationBucket() const {
+        if (!continuationKernel || !options.fixedSizeKernels) return {0, 0};
+        return {continuationKernel->states, continuationKernel->support};
+    }
+    
+    const SolverOptions& solverOptions() const {
+        return options;
+    }
+    
+    // Runs the parallel sweeps on a shared executor instead of the engine's
+    // own pool; nullptr goes back to the pool. The executor must outlive its
+    // use here.
+    void setExecutor(ParallelExecutor* sharedExecutor) {
+        executor = sharedExecutor;
+    }
+    
+    // Q(s, a) = R(s) - ordering(a) + gamma * G(s + a), where G(y) is the expected
+    // continuation from order-up-to level y. G is built once per sweep, and the
+    // best action is a running max over y >= s scanned from the top.
+    double postDecisionSweep() {
+        return postDecisionBackup(valueFunction.data(), valueFunction.data(), policy.data());
+    }
+    
+    // Applies the Bellman operator to values, writing T(values) and its greedy
+    // policy. newValues may alias values because G is built before the scan.
+    double postDecisionBackup(const Real* values, Real* newValues, int* newPolicy) {
+        double probabilityMass = demandModel->totalMass();
+        
+        if (continuationKernel && options.fixedSizeKernels) {
+            continuationKernel->kernel(kernels->isa)(values, maxInventory + 1, demandModel->pmfData(), demandModel->tailData(),
+                                    demandModel->support(), postDecisionValues.data());
+            continuationKernel->hits++;
+        } else {
+            forEachChunk(maxInventory + 1, [&](int begin, int end, int) {
+                for (int level = begin; level < end; ++level) {
+                    postDecisionValues[level] = continuationValue(values, level);
+                }
+            });
+            ContinuationKernels<Real>::genericHits()++;
+        }
+        
+        double unitCost = 5.0 * probabilityMass;
+        double bestOrderValue = -std::numeric_limits<double>::infinity();
+        int bestLevel = maxInventory;
+        double delta = 0.0;
+        
+        for (int state = maxInventory; state >= 0; --state) {
+            double newValue = stateRewards[state] + gamma * postDecisionValues[state];
+            int bestAction = 0;
+            
+            if (state < maxInventory) {
+                double orderValue = stateRewards[state] - probabilityMass * orderCost +
+                                    unitCost * state + bestOrderValue;
+                if (orderValue > newValue) {
+                    newValue = orderValue;
+                    bestAction = bestLevel - state;
+                }
+            }
+            
+            double levelValue = gamma * postDecisionValues[state] - unitCost * state;
+            if (levelValue >= bestOrderValue) {
+                bestOrderValue = levelValue;
+                bestLevel = state;
+            }
+            
+            delta = std::max(delta, std::abs(values[state] - newValue));
+            newValues[state] = newValue;
+            newPolicy[state] = bestAction;
+        }
+        
+        return delta;
+    }
+    
+    
+    // Every transition row carries the same probability mass, so the Bellman
+    // operator contracts by gamma * mass rather than by gamma.
+    double effectiveDiscount() const {
+        return gamma * demandModel->totalMass();
+    }
+    
+    bool jacobiTypeSweep() const {
+        return options.backup == BackupMode::PostDecision || options.schedule == SweepSchedule::Jacobi;
+    }
+    
+    // MacQueen/Porteus bounds from the change of the last sweep. With
+    // extrapolation, V moves to the midpoint of its bounds. That removes the
+    // slowly decaying constant component of the error.
+    void updateBounds(ConvergenceInfo& info, double delta) {
+        double beta = effectiveDiscount();
+        double factor = beta / (1.0 - beta);
+        
+        if (jacobiTypeSweep()) {
+            double lowest = std::numeric_limits<double>::infinity();
+            double highest = -std::numeric_limits<double>::infinity();
+            for (int state = 0; state <= maxInventory; ++state) {
+                double change = valueFunction[state] - previousValues[state];
+                lowest = std::min(lowest, change);
+                highest = std::max(highest, change);
+            }
+            info.lowerBoundShift = factor * lowest;
+            info.upperBoundShift = factor * highest;
+            info.optimalityGap = info.upperBoundShift - info.lowerBoundShift;
+            
+            if (options.extrapolate) {
+                double midpoint = 0.5 * (info.lowerBoundShift + info.upperBoundShift);
+                for (Real& value : valueFunction) value += midpoint;
+                info.lowerBoundShift -= midpoint;
+                info.upperBoundShift -= midpoint;
+            }
+        } else {
+            info.lowerBoundShift = -factor * delta;
+            info.upperBoundShift = factor * delta;
+            info.optimalityGap = 2.0 * factor * delta;
+        }
+        
+        info.gapHistory.push_back(info.optimalityGap);
+    }
+    
+    // Smallest tolerance the value type can resolve: a few ulps of |V|, in
+    // the units of the active stopping rule. Sweeps stop changing V well
+    // before the delta drops under it, so a smaller epsilon is raised to it.
+    double roundingFloor() const {
+        double largest = 0.0;
+        for (Real value : valueFunction) {
+            largest = std::max(largest, static_cast<double>(std::abs(value)));
+        }
+        double floor = 8.0 * std::numeric_limits<Real>::epsilon() * largest;
+        if (options.stopping == StoppingRule::Span) {
+            double beta = effectiveDiscount();
+            floor *= 2.0 * beta / (1.0 - beta);
+        }
+        return floor;
+    }
+    
+    ConvergenceInfo valueIteration(double epsilon = 0.01, int maxIterations = 1000) {
+        if constexpr (std::is_same<Real, double>::value) {
+            if (options.mixedPrecision) return mixedPrecisionValueIteration(epsilon, maxIterations);
+        }
+        
+        ConvergenceInfo info;
+        info.converged = false;
+        int firstIteration = resumedIterations;
+        info.iterations = firstIteration;
+        info.deltaHistory = std::move(resumedHistory);
+        info.warmStartBackups = warmStartBackups;
+        info.backups = warmStartBackups;
+        resumedIterations = 0;
+        resumedHistory.clear();
+        warmStartBackups = 0;
+        
+        bool verifying = false;
+        bool fullScanForced = false;
+        std::vector<int> prunedPolicy;
+        // Elimination supersedes the window search: both restrict the scan.
+        pruningActive = options.structuralPruning && !options.actionElimination &&
+                        options.backup == BackupMode::Standard;
+        bool accelerated = options.andersonDepth > 0 || options.relaxation != 1.0;
+        resetAccelerator();
+        if (options.actionElimination && activeActions.size() != static_cast<size_t>(maxInventory + 1)) {
+            activeActions.assign(maxInventory + 1, std::vector<int>());
+        }
+        
+        for (int iteration = firstIteration; iteration < maxIterations; ++iteration) {
+            double delta = 0.0;
+            previousValues = valueFunction;
+            
+            if (options.backup == BackupMode::PostDecision) {
+                delta = postDecisionSweep();
+            } else {
+                delta = standardSweep();
+            }
+            
+            info.deltaHistory.push_back(delta);
+            info.iterations = iteration + 1;
+            info.finalDelta = delta;
+            info.backups += maxInventory + 1;
+            updateBounds(info, delta);
+            eliminationMargin = effectiveDiscount() * info.optimalityGap;
+            if (options.checkpointInterval > 0 && info.iterations % options.checkpointInterval == 0) {
+                checkpoint(info);
+            }
+            
+            double tolerance = std::max(epsilon, roundingFloor());
+            bool withinTolerance = (options.stopping == StoppingRule::Span)
+                ? info.optimalityGap < tolerance
+                : delta < tolerance;
+            
+            if (verifying) {
+                verifying = false;
+                if (policy != prunedPolicy) {
+                    info.pruningFallback = true;
+                } else if (!withinTolerance) {
+                    pruningActive = true;
+                }
+            } else if (fullScanForced) {
+                fullScanForced = false;
+                pruningActive = true;
+            } else if (pruningActive && !orderLevelsMonotone()) {
+                // The window search broke the structure: rescan fully once.
+                pruningActive = false;
+                fullScanForced = true;
+                info.fullScanSweeps++;
+            }
+            
+            if (withinTolerance) {
+                if (pruningActive || fullScanForced) {
+                    // Converged under the restricted search: confirm with a full scan.
+                    pruningActive = false;
+                    fullScanForced = false;
+                    verifying = true;
+                    prunedPolicy = policy;
+                    continue;
+                }
+                info.converged = true;
+                break;
+            }
+            
+            if (accelerated && accelerateIterate(info)) {
+                // The bounds describe the plain backup, not the mixed iterate.
+                eliminationMargin = std::numeric_limits<double>::infinity();
+            }
+        }
+        
+        pruningActive = false;
+        resetAccelerator();
+        eliminationMargin = std::numeric_limits<double>::infinity();
+        info.eliminatedActions = countEliminatedActions();
+        if (options.checkpointInterval > 0) {
+            checkpoint(info);
+            if (checkpointWriter) checkpointWriter->flush();
+        }
+        return info;
+    }
+    
+    // Hands a copy of the run state to the background writer.
+    void checkpoint(const ConvergenceInfo& info) {
+        if (options.checkpointPath.empty()) return;
+        if (!checkpointWriter || checkpointWriter->path() != options.checkpointPath) {
+            checkpointWriter = std::make_unique<CheckpointWriter>(options.checkpointPath);
+        }
+        SolverCheckpoint state;
+        state.config = config();
+        state.iterations = info.iterations;
+        state.values.assign(valueFunction.begin(), valueFunction.end());
+        state.policy = policy;
+        state.deltaHistory = info.deltaHistory;
+        checkpointWriter->submit(std::move(state));
+    }
+    
+    // Loads V, the policy and the run so far from a checkpoint of this
+    // configuration; the next valueIteration continues from there, counting
+    // the checkpointed sweeps against its maxIterations. Returns false, and
+    // leaves the engine untouched, if the file is unreadable or belongs to
+    // another configuration.
+    bool resumeFromCheckpoint(const std::string& filename) {
+        SolverCheckpoint state;
+        if (!CheckpointFile::read(filename, state)) return false;
+        if (state.config.hash() != config().hash() || state.config != config()) {
+            std::cerr << "Checkpoint " << filename << " belongs to another configuration" << std::endl;
+            return false;
+        }
+        valueFunction.assign(state.values.begin(), state.values.end());
+        policy = state.policy;
+        resumedIterations = state.iterations;
+        resumedHistory = std::move(state.deltaHistory);
+        warmStartBackups = 0;
+        return true;
+    }
+    
+    int checkpointsWritten() const {
+        return checkpointWriter ? checkpointWriter->checkpointsWritten() : 0;
+    }
+    
+    // Runs the bulk of the sweeps on a float copy of this engine, then
+    // finishes here in double from the float values. The float phase stops
+    // at epsilon or at its rounding floor, and skips action elimination,
+    // whose bounds do not survive float rounding. Both phases share
+    // maxIterations; if the float phase uses it up, the run ends there,
+    // unconverged. The returned info covers both phases;
+    // singlePrecisionSweeps counts the float ones. The float engine is kept
+    // across calls and shares this engine's demand table.
+    ConvergenceInfo mixedPrecisionValueIteration(double epsilon, int maxIterations) {
+        if (!singlePrecisionEngine) singlePrecisionEngine = std::make_unique<BasicMDPEngine<float>>(config());
+        BasicMDPEngine<float>& single = *singlePrecisionEngine;
+        SolverOptions singleOptions = options;
+        singleOptions.mixedPrecision = false;
+        singleOptions.actionElimination = false;
+        singleOptions.qStorage = QStorage::None;
+        single.setSolverOptions(singleOptions);
+        single.setExecutor(executor);
+        single.applyConfig(config(), demandModel);
+        single.valueFunction.assign(valueFunction.begin(), valueFunction.end());
+        single.policy = policy;
+        single.resumedIterations = resumedIterations;
+        single.resumedHistory = std::move(resumedHistory);
+        resumedIterations = 0;
+        
+        ConvergenceInfo singleInfo = single.valueIteration(epsilon, maxIterations);
+        valueFunction.assign(single.valueFunction.begin(), single.valueFunction.end());
+        policy = single.policy;
+        
+        if (singleInfo.iterations >= maxIterations) {
+            ConvergenceInfo info = std::move(singleInfo);
+            info.converged = false;
+            info.singlePrecisionSweeps = info.iterations;
+            info.warmStartBackups = warmStartBackups;
+            info.backups += warmStartBackups;
+            warmStartBackups = 0;
+            return info;
+        }
+        
+        // The double phase continues the float run's count and history, so
+        // its checkpoints number sweeps the same way.
+        options.mixedPrecision = false;
+        resumedIterations = singleInfo.iterations;
+        resumedHistory = singleInfo.deltaHistory;
+        ConvergenceInfo info = valueIteration(epsilon, maxIterations);
+        options.mixedPrecision = true;
+        
+        info.singlePrecisionSweeps = singleInfo.iterations;
+        info.backups += singleInfo.backups;
+        info.gapHistory.insert(info.gapHistory.begin(), singleInfo.gapHistory.begin(),
+                               singleInfo.gapHistory.end());
+        info.pruningFallback = info.pruningFallback || singleInfo.pruningFallback;
+        info.fullScanSweeps += singleInfo.fullScanSweeps;
+        info.acceleratorFallbacks += singleInfo.acceleratorFallbacks;
+        return info;
+    }
+    
+    void resetAccelerator() {
+        andersonIterateSteps.clear();
+        andersonResidualSteps.clear();
+        andersonIterate.clear();
+        andersonResidual.clear();
+        acceleratorResidual = std::numeric_limits<double>::infinity();
+    }
+    
+    // Treats one sweep as the map x -> g(x), with x in previousValues and g(x)
+    // in valueFunction, and replaces valueFunction by the Anderson-mixed,
+    // relaxed next iterate
+    //   x + w f - (dX + w dF) c,   c = argmin |f - dF c|,   f = g(x) - x,
+    // over the last andersonDepth differences. If the residual grew since the
+    // previous step, the plain backup is kept for this step instead; the step
+    // still enters the history.
+    // Returns true when valueFunction was moved off the plain backup.
+    bool accelerateIterate(ConvergenceInfo& info) {
+        size_t n = valueFunction.size();
+        std::vector<Real> residual(n);
+        double residualNorm = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            residual[i] = valueFunction[i] - previousValues[i];
+            residualNorm = std::max(residualNorm, static_cast<double>(std::abs(residual[i])));
+        }
+        
+        bool fallback = residualNorm > acceleratorResidual;
+        acceleratorResidual = residualNorm;
+        if (fallback) info.acceleratorFallbacks++;
+        
+        if (options.andersonDepth > 0 && !andersonIterate.empty()) {
+            std::vector<Real> iterateStep(n), residualStep(n);
+            for (size_t i = 0; i < n; ++i) {
+                iterateStep[i] = previousValues[i] - andersonIterate[i];
+                residualStep[i] = residual[i] - andersonResidual[i];
+            }
+            andersonIterateSteps.push_back(std::move(iterateStep));
+            andersonResidualSteps.push_back(std::move(residualStep));
+            if (static_cast<int>(andersonIterateSteps.size()) > options.andersonDepth) {
+                andersonIterateSteps.erase(andersonIterateSteps.begin());
+                andersonResidualSteps.erase(andersonResidualSteps.begin());
+            }
+        }
+        andersonIterate = previousValues;
+        andersonResidual = residual;
+        if (fallback) return false;
+        
+        double omega = options.relaxation;
+        for (size_t i = 0; i < n; ++i) valueFunction[i] = previousValues[i] + omega * residual[i];
+        
+        int m = static_cast<int>(andersonResidualSteps.size());
+        if (m == 0) return omega != 1.0;
+        
+        // Normal equations, lightly regularized against near-collinear steps.
+        std::vector<double> system(static_cast<size_t>(m) * (m + 1));
+        double trace = 0.0;
+        for (int a = 0; a < m; ++a) {
+            for (int b = a; b < m; ++b) {
+                double product = kernels->dot(andersonResidualSteps[a].data(), andersonResidualSteps[b].data(),
+                                              static_cast<int>(n));
+                system[static_cast<size_t>(a) * (m + 1) + b] = product;
+                system[static_cast<size_t>(b) * (m + 1) + a] = product;
+            }
+            system[static_cast<size_t>(a) * (m + 1) + m] =
+                kernels->dot(andersonResidualSteps[a].data(), residual.data(), static_cast<int>(n));
+            trace += system[static_cast<size_t>(a) * (m + 1) + a];
+        }
+        if (trace == 0.0) return omega != 1.0;
+        for (int a = 0; a < m; ++a) system[static_cast<size_t>(a) * (m + 1) + a] += 1e-10 * trace / m;
+        
+        std::vector<double> coefficients = solveDense(system, m);
+        for (double c : coefficients) {
+            if (!std::isfinite(c)) return omega != 1.0;
+        }
+        
+        for (int a = 0; a < m; ++a) {
+            const std::vector<Real>& iterateStep = andersonIterateSteps[a];
+            const std::vector<Real>& residualStep = andersonResidualSteps[a];
+            for (size_t i = 0; i < n; ++i) {
+                valueFunction[i] -= coefficients[a] * (iterateStep[i] + omega * residualStep[i]);
+            }
+        }
+        return true;
+    }
+    
+    // Backs up one state at a time, in order of Bellman residual. G(y) and
+    // H(y) = gamma G(y) - c y are maintained incrementally, so a backup costs
+    // O(log N) for the action search plus O(D log N) to push its value change
+    // into the levels y in [s, s + maxDemand].
+    //
+    // Work proceeds in rounds. A round pops every state queued with a residual
+    // of at least epsilon once, largest first. Re-scoring is deferred to the
+    // end of the round: a verification pass backs up only the states whose
+    // inputs moved since their last backup, namely those with G(s) in a
+    // changed band and those whose max of H over (s, N] differs from the one
+    // they last read, found by one suffix-max scan. Re-scoring per pop instead
+    // would cost up to D backups each. Every row of the transition kernel has
+    // the same mass, so the pass also removes the constant part of the
+    // residual by shifting V by mid(r) / (1 - beta); that moves every residual
+    // by the same amount and needs no backups. When the queue drains, one
+    // full pass from a freshly computed G confirms convergence.
+    //
+    // Each verification pass counts as one iteration in the returned
+    // ConvergenceInfo, and backups counts every state backup, those of the
+    // passes included. A warm start left by reconfigure() is charged as in
+    // valueIteration.
+    ConvergenceInfo prioritizedSweeping(double epsilon = 0.01, long long maxBackups = 100000000) {
+        ConvergenceInfo info;
+        info.iterations = resumedIterations;
+        info.deltaHistory = std::move(resumedHistory);
+        info.warmStartBackups = warmStartBackups;
+        info.backups = warmStartBackups;
+        resumedIterations = 0;
+        resumedHistory.clear();
+        warmStartBackups = 0;
+        
+        int maxDemand = demandModel->maxValue();
+        const double* pmf = demandModel->pmfData();
+        double probabilityMass = demandModel->totalMass();
+        double unitCost = 5.0 * probabilityMass;
+        
+        std::vector<double> levelValues(maxInventory + 1);
+        // Signed residual T V(s) - V(s) as of the last backup of s, and the
+        // inputs that backup used: G(s) is stale while changed[s] is set, and
+        // seenMax[s] is the max of H over (s, N] it read.
+        std::vector<double> residuals(maxInventory + 1);
+        std::vector<char> changed(maxInventory + 1, 0);
+        std::vector<double> seenMax(maxInventory + 1, -std::numeric_limits<double>::infinity());
+        MaxSegmentTree levelTree;
+        IndexedMaxHeap queue(maxInventory + 1);
+        
+        auto backup = [&](int state) -> std::pair<double, int> {
+            info.backups++;
+            changed[state] = 0;
+            double noOrder = stateRewards[state] + gamma * postDecisionValues[state];
+            if (state == maxInventory) return {noOrder, 0};
+            auto [best, level] = levelTree.query(state + 1, maxInventory);
+            seenMax[state] = best;
+            double orderValue = stateRewards[state] - probabilityMass * orderCost + unitCost * state + best;
+            return (orderValue > noOrder) ? std::make_pair(orderValue, level - state) : std::make_pair(noOrder, 0);
+        };
+        
+        auto refresh = [&](int state) {
+            auto [newValue, bestAction] = backup(state);
+            residuals[state] = newValue - valueFunction[state];
+            policy[state] = bestAction;
+        };
+        
+        auto assignLevels = [&]() {
+            for (int level = 0; level <= maxInventory; ++level) {
+                levelValues[level] = gamma * postDecisionValues[level] - unitCost * level;
+            }
+            levelTree.assign(levelValues);
+        };
+        
+        // Full pass from a fresh G; also clears the drift of the incremental G.
+        auto rescoreAll = [&]() {
+            for (int level = 0; level <= maxInventory; ++level) {
+                postDecisionValues[level] = continuationValue(valueFunction.data(), level);
+            }
+            assignLevels();
+            for (int state = 0; state <= maxInventory; ++state) {
+                refresh(state);
+            }
+        };
+        
+        rescoreAll();
+        bool fresh = true;
+        
+        while (info.backups < maxBackups) {
+            double suffixMax = -std::numeric_limits<double>::infinity();
+            for (int state = maxInventory; state >= 0; --state) {
+                if (changed[state] || (state < maxInventory && seenMax[state] != suffixMax)) refresh(state);
+                suffixMax = std::max(suffixMax, levelValues[state]);
+            }
+            
+            auto [lowest, highest] = std::minmax_element(residuals.begin(), residuals.end());
+            double shift = 0.5 * (*lowest + *highest);
+            double offset = shift / (1.0 - gamma * probabilityMass);
+            for (int state = 0; state <= maxInventory; ++state) {
+                valueFunction[state] += offset;
+                postDecisionValues[state] += probabilityMass * offset;
+            }
+            assignLevels();
+            
+            double maxResidual = 0.0;
+            queue.clear();
+            suffixMax = -std::numeric_limits<double>::infinity();
+            for (int state = maxInventory; state >= 0; --state) {
+                residuals[state] -= shift;
+                if (state < maxInventory) seenMax[state] = suffixMax;
+                suffixMax = std::max(suffixMax, levelValues[state]);
+                double residual = std::abs(residuals[state]);
+                maxResidual = std::max(maxResidual, residual);
+                if (residual >= epsilon) queue.set(state, residual);
+            }
+            
+            info.iterations++;
+            info.deltaHistory.push_back(maxResidual);
+            info.finalDelta = maxResidual;
+            
+            if (queue.empty()) {
+                if (fresh) {
+                    info.converged = true;
+                    break;
+                }
+                rescoreAll();
+                fresh = true;
+                continue;
+            }
+            fresh = false;
+            
+            while (!queue.empty() && info.backups < maxBackups) {
+                int state = queue.pop();
+                auto [newValue, bestAction] = backup(state);
+                double change = newValue - valueFunction[state];
+                
+                valueFunction[state] = newValue;
+                residuals[state] = 0.0;
+                policy[state] = bestAction;
+                
+                if (change == 0.0) continue;
+                
+                int lastLevel = std::min(maxInventory, state + maxDemand);
+                for (int level = state; level <= lastLevel; ++level) {
+                    double weight = (state > 0) ? pmf[level - state]
+                                                : pmf[level] + demandModel->tailMass(level);
+                    postDecisionValues[level] += weight * change;
+                    levelValues[level] = gamma * postDecisionValues[level] - unitCost * level;
+                    levelTree.update(level, levelValues[level]);
+                    changed[level] = 1;
+                }
+            }
+        }
+        
+        return info;
+    }
+    
+    // Exact V^pi for the current policy. Non-ordering states only reach states
+    // at or below themselves within the demand band, so they are solved by
+    // forward substitution. Ordering states depend only on G at their
+    // order-up-to level, and an (s,S)-type policy has very few distinct levels.
+    // Each V(s) is therefore carried as an affine function of those k unknown
+    // G values, and a dense k x k system closes the loop in O(N D k + k^3).
+    // Policies with many distinct levels fall back to BiCGSTAB on
+    // (I - gamma P_pi) V = r_pi, which only needs O(N D) matrix-vector products.
+    // Returns the passes over the states it made: one for the direct solve,
+    // one per operator product for Krylov.
+    int evaluatePolicy(PolicyEvaluation method = PolicyEvaluation::Auto) {
+        std::vector<int> levelIndex(maxInventory + 1, -1);
+        std::vector<int> levels;
+        for (int state = 0; state <= maxInventory; ++state) {
+            int level = state + policy[state];
+            if (policy[state] > 0 && levelIndex[level] < 0) {
+                levelIndex[level] = static_cast<int>(levels.size());
+                levels.push_back(level);
+            }
+        }
+        
+        bool direct = (method == PolicyEvaluation::Direct) ||
+                      (method == PolicyEvaluation::Auto && levels.size() <= 64);
+        if (direct) {
+            evaluatePolicyDirect(levels, levelIndex);
+            return 1;
+        }
+        return evaluatePolicyKrylov();
+    }
+    
+    void evaluatePolicyDirect(const std::vector<int>& levels, const std::vector<int>& levelIndex) {
+        int maxDemand = demandModel->maxValue();
+        const double* pmf = demandModel->pmfData();
+        int k = static_cast<int>(levels.size());
+        int width = k + 1;
+        
+        // affine[s * width + 0] is the constant term, entry 1 + j the coefficient of g_j.
+        std::vector<double> affine(static_cast<size_t>(maxInventory + 1) * width, 0.0);
+        auto row = [&](int state) { return affine.data() + static_cast<size_t>(state) * width; };
+        
+        for (int state = 0; state <= maxInventory; ++state) {
+            double* out = row(state);
+            out[0] = stateRewards[state] - expectedOrderingCost(policy[state]);
+            
+            if (policy[state] > 0) {
+                out[1 + levelIndex[state + policy[state]]] = gamma;
+                continue;
+            }
+            
+            double diagonal = (state == 0) ? demandModel->totalMass() : pmf[0];
+            int interior = std::min(state, maxDemand);
+            for (int d = 1; d <= interior; ++d) {
+                const double* in = row(state - d);
+                for (int j = 0; j < width; ++j) {
+                    out[j] += gamma * pmf[d] * in[j];
+                }
+            }
+            if (state > 0 && state < maxDemand) {
+                const double* in = row(0);
+                double weight = gamma * demandModel->tailMass(state);
+                for (int j = 0; j < width; ++j) {
+                    out[j] += weight * in[j];
+                }
+            }
+            
+            double scale = 1.0 / (1.0 - gamma * diagonal);
+            for (int j = 0; j < width; ++j) {
+                out[j] *= scale;
+            }
+        }
+        
+        std::vector<double> levelValues(k, 0.0);
+        if (k > 0) {
+            // g_i = sum_d w_d V(y_i - d)  =>  (I - B) g = a
+            std::vector<double> system(static_cast<size_t>(k) * (k + 1), 0.0);
+            for (int i = 0; i < k; ++i) {
+                double* eq = system.data() + static_cast<size_t>(i) * (k + 1);
+                int level = levels[i];
+                int interior = std::min(level, maxDemand);
+                for (int d = 0; d <= interior; ++d) {
+                    const double* in = row(level - d);
+                    eq[k] += pmf[d] * in[0];
+                    for (int j = 0; j < k; ++j) eq[j] -= pmf[d] * in[1 + j];
+                }
+                if (level < maxDemand) {
+                    const double* in = row(0);
+                    double weight = demandModel->tailMass(level);
+                    eq[k] += weight * in[0];
+                    for (int j = 0; j < k; ++j) eq[j] -= weight * in[1 + j];
+                }
+                eq[i] += 1.0;
+            }
+            levelValues = solveDense(system, k);
+        }
+        
+        for (int state = 0; state <= maxInventory; ++state) {
+            const double* in = row(state);
+            double value = in[0];
+            for (int j = 0; j < k; ++j) value += in[1 + j] * levelValues[j];
+            valueFunction[state] = value;
+        }
+    }
+    
+    // Gaussian elimination with partial pivoting on a row-major n x (n + 1)
+    // augmented matrix.
+    static std::vector<double> solveDense(std::vector<double>& system, int n) {
+        auto at = [&](int r, int c) -> double& { return system[static_cast<size_t>(r) * (n + 1) + c]; };
+        
+        for (int col = 0; col < n; ++col) {
+            int pivot = col;
+            for (int r = col + 1; r < n; ++r) {
+                if (std::abs(at(r, col)) > std::abs(at(pivot, col))) pivot = r;
+            }
+            for (int c = 0; c <= n; ++c) std::swap(at(col, c), at(pivot, c));
+            for (int r = col + 1; r < n; ++r) {
+                double factor = at(r, col) / at(col, col);
+                if (factor == 0.0) continue;
+                for (int c = col; c <= n; ++c) at(r, c) -= factor * at(col, c);
+            }
+        }
+        
+        std::vector<double> x(n);
+        for (int r = n - 1; r >= 0; --r) {
+            double sum = at(r, n);
+            for (int c = r + 1; c < n; ++c) sum -= at(r, c) * x[c];
+            x[r] = sum / at(r, r);
+        }
+        return x;
+    }
+    
+    // out = values - gamma * P_pi values
+    void applyPolicyOperator(const std::vector<Real>& values, std::vector<Real>& out) {
+        forEachChunk(maxInventory + 1, [&](int begin, int end, int) {
+            for (int state = begin; state < end; ++state) {
+                out[state] = values[state] - gamma * continuationValue(values.data(), state + policy[state]);
+            }
+        });
+    }
+    
+    int evaluatePolicyKrylov(double tolerance = std::is_same<Real, float>::value ? 1e-6 : 1e-12,
+                             int maxIterations = 1000) {
+        size_t n = valueFunction.size();
+        int products = 1;
+        std::vector<Real> rhs(n), residual(n), shadow(n), direction(n, 0), image(n, 0), partial(n), partialImage(n);
+        
+        auto dot = [&](const std::vector<Real>& a, const std::vector<Real>& b) -> double {
+            return kernels->dot(a.data(), b.data(), static_cast<int>(n));
+        };
+        
+        for (int state = 0; state <= maxInventory; ++state) {
+            rhs[state] = stateRewards[state] - expectedOrderingCost(policy[state]);
+        }
+        
+        std::vector<Real>& x = valueFunction;
+        applyPolicyOperator(x, residual);
+        for (size_t i = 0; i < n; ++i) residual[i] = rhs[i] - residual[i];
+        shadow = residual;
+        
+        double threshold = tolerance * std::max(1.0, std::sqrt(dot(rhs, rhs)));
+        double rho = 1.0, alpha = 1.0, omega = 1.0;
+        
+        for (int iteration = 0; iteration < maxIterations; ++iteration) {
+            if (std::sqrt(dot(residual, residual)) < threshold) break;
+            
+            double rhoNext = dot(shadow, residual);
+            if (rhoNext == 0.0) break;
+            double beta = (rhoNext / rho) * (alpha / omega);
+            rho = rhoNext;
+            for (size_t i = 0; i < n; ++i) {
+                direction[i] = residual[i] + beta * (direction[i] - omega * image[i]);
+            }
+            
+            applyPolicyOperator(direction, image);
+            ++products;
+            alpha = rho / dot(shadow, image);
+            for (size_t i = 0; i < n; ++i) partial[i] = residual[i] - alpha * image[i];
+            
+            if (std::sqrt(dot(partial, partial)) < threshold) {
+                for (size_t i = 0; i < n; ++i) x[i] += alpha * direction[i];
+                break;
+            }
+            
+            applyPolicyOperator(partial, partialImage);
+            ++products;
+            omega = dot(partialImage, partial) / dot(partialImage, partialImage);
+            for (size_t i = 0; i < n; ++i) {
+                x[i] += alpha * direction[i] + omega * partial[i];
+                residual[i] = partial[i] - omega * partialImage[i];
+            }
+            if (omega == 0.0) break;
+        }
+        return products;
+    }
+    
+    // Howard's policy iteration: exact evaluation, then greedy improvement that
+    // keeps the incumbent action unless another one is strictly better. Each
+    // iteration's delta is the Bellman residual of V^pi, so a stable policy
+    // ends with a delta of (numerically) zero.
+    ConvergenceInfo policyIteration(int maxIterations = 100) {
+        ConvergenceInfo info;
+        info.converged = false;
+        info.iterations = 0;
+        info.finalDelta = 0.0;
+        
+        std::vector<Real> improvedValues(maxInventory + 1);
+        std::vector<int> improvedPolicy(maxInventory + 1);
+        double probabilityMass = demandModel->totalMass();
+        double relativeTolerance = std::max(1e-10, 16.0 * std::numeric_limits<Real>::epsilon());
+        
+        for (int iteration = 0; iteration < maxIterations; ++iteration) {
+            evaluatePolicy(options.evaluation);
+            
+            double delta = postDecisionBackup(valueFunction.data(), improvedValues.data(), improvedPolicy.data());
+            info.backups += maxInventory + 1;
+            info.iterations = iteration + 1;
+            info.deltaHistory.push_back(delta);
+            info.finalDelta = delta;
+            
+            bool stable = true;
+            for (int state = 0; state <= maxInventory; ++state) {
+                if (improvedPolicy[state] == policy[state]) continue;
+                double incumbent = valueFunction[state];
+                double tolerance = relativeTolerance * std::max(1.0, std::abs(incumbent)) * probabilityMass;
+                if (improvedValues[state] > incumbent + tolerance) {
+                    policy[state] = improvedPolicy[state];
+                    stable = false;
+                }
+            }
+            
+            if (stable) {
+                info.converged = true;
+                break;
+            }
+        }
+        
+        return info;
+    }
+    
+    // Modified policy iteration: one greedy backup followed by m partial
+    // evaluation sweeps under the greedy policy. m = 0 is Jacobi value
+    // iteration; large m approaches policy iteration. Stops on the same
+    // sup-norm test as valueIteration.
+    ConvergenceInfo modifiedPolicyIteration(int m, double epsilon = 0.01, int maxIterations = 1000) {
+        ConvergenceInfo info;
+        info.converged = false;
+        info.iterations = 0;
+        info.finalDelta = 0.0;
+        
+        nextValues.resize(valueFunction.size());
+        
+        for (int iteration = 0; iteration < maxIterations; ++iteration) {
+            double delta = postDecisionBackup(valueFunction.data(), valueFunction.data(), policy.data());
+            info.backups += maxInventory + 1;
+            info.iterations = iteration + 1;
+            info.deltaHistory.push_back(delta);
+            info.finalDelta = delta;
+            
+            if (delta < epsilon) {
+                info.converged = true;
+                break;
+            }
+            
+            for (int sweep = 0; sweep < m; ++sweep) {
+                const Real* values = valueFunction.data();
+                forEachChunk(maxInventory + 1, [&](int begin, int end, int) {
+                    for (int state = begin; state < end; ++state) {
+                        nextValues[state] = stateRewards[state] - expectedOrderingCost(policy[state]) +
+                                            gamma * continuationValue(values, state + policy[state]);
+                    }
+                });
+                valueFunction.swap(nextValues);
+            }
+        }
+        
+        return info;
+    }
+    
+    struct AccelerationReport {
+        std::string method;
+        bool converged;
+        int iterations;
+        int fallbacks;
+        double seconds;
+    };
+    
+    // Solves from V = 0 with the plain sweep, with relaxation alone and with
+    // Anderson mixing, keeping the current backup and schedule. The engine's
+    // own value function, policy and options are left unchanged.
+    std::vector<AccelerationReport> compareAcceleration(double epsilon = 0.01, int maxIterations = 1000,
+                                                        int andersonDepth = 5, double relaxation = 1.2) {
+        std::vector<AccelerationReport> reports;
+        SolverOptions savedOptions = options;
+        std::vector<Real> savedValues = valueFunction;
+        std::vector<int> savedPolicy = policy;
+        
+        std::ostringstream relaxedName, andersonName;
+        relaxedName << "SOR (w = " << relaxation << ")";
+        andersonName << "Anderson (m = " << andersonDepth << ")";
+        const std::vector<std::pair<std::string, std::pair<int, double>>> methods = {
+            {"Plain", {0, 1.0}},
+            {relaxedName.str(), {0, relaxation}},
+            {andersonName.str(), {andersonDepth, 1.0}},
+        };
+        
+        for (const auto& method : methods) {
+            options.andersonDepth = method.second.first;
+            options.relaxation = method.second.second;
+            std::fill(valueFunction.begin(), valueFunction.end(), 0.0);
+            
+            auto start = std::chrono::steady_clock::now();
+            ConvergenceInfo info = valueIteration(epsilon, maxIterations);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            
+            reports.push_back({method.first, info.converged, info.iterations, info.acceleratorFallbacks,
+                               elapsed.count()});
+        }
+        
+        options = savedOptions;
+        valueFunction = savedValues;
+        policy = savedPolicy;
+        return reports;
+    }
+    
+    struct ScheduleReport {
+        SweepSchedule schedule;
+        bool converged;
+        int iterations;
+        double seconds;
+    };
+    
+    // Solves from V = 0 once per schedule and reports sweeps-to-epsilon. The
+    // engine's own value function, policy and options are left unchanged.
+    std::vector<ScheduleReport> compareSweepSchedules(double epsilon = 0.01, int maxIterations = 1000) {
+        std::vector<ScheduleReport> reports;
+        SolverOptions savedOptions = options;
+        std::vector<Real> savedValues = valueFunction;
+        std::vector<int> savedPolicy = policy;
+        
+        for (SweepSchedule schedule : {SweepSchedule::Jacobi, SweepSchedule::GaussSeidelAscending,
+                                       SweepSchedule::GaussSeidelDescending, SweepSchedule::RedBlack}) {
+            options.backup = BackupMode::Standard;
+            options.schedule = schedule;
+            std::fill(valueFunction.begin(), valueFunction.end(), 0.0);
+            
+            auto start = std::chrono::steady_clock::now();
+            ConvergenceInfo info = valueIteration(epsilon, maxIterations);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            
+            reports.push_back({schedule, info.converged, info.iterations, elapsed.count()});
+        }
+        
+        options = savedOptions;
+        valueFunction = savedValues;
+        policy = savedPolicy;
+        return reports;
+    }
+    
+    std::pair<int, int> computeSSpolicy() {
+        std::vector<int> reorderPoints;
+        std::vector<int> orderUpTo;
+        
+        for (int state = 0; state <= maxInventory; ++state) {
+            if (policy[state] > 0) {
+                reorderPoints.push_back(state);
+                orderUpTo.push_back(state + policy[state]);
+            }
+        }
+        
+        int s = reorderPoints.empty() ? maxInventory / 3 : *std::max_element(reorderPoints.begin(), reorderPoints.end());
+        int S = orderUpTo.empty() ? (2 * maxInventory / 3) : 
+                std::accumulate(orderUpTo.begin(), orderUpTo.end(), 0) / orderUpTo.size();
+        
+        return {s, S};
+    }
+    
+    int generateDemand() {
+        return demandModel->sample(gen);
+    }
+    
+    struct SimulationStep {
+        int step;
+        int state;
+        int action;
+        int demand;
+        double reward;
+        int nextState;
+    };
+    
+    struct SimulationResult {
+        std::vector<SimulationStep> trajectory;
+        double totalReward;
+        double averageReward;
+    };
+    
+    SimulationResult simulateEpisode(int initialState, int steps, const std::string& transportMode) {
+        SimulationResult result;
+        int state = initialState;
+        double totalReward = 0.0;
+        
+        for (int step = 0; step < steps; ++step) {
+            int action = policy[state];
+            int demand = generateDemand();
+            double reward = immediateReward(state, action, demand);
+            
+            if (action > 0 && transportModes.find(transportMode) != transportModes.end()) {
+                reward -= transportModes[transportMode].cost;
+            }
+            
+            int nextState = std::max(0, std::min(maxInventory, state + action - demand));
+            
+            result.trajectory.push_back({step, state, action, demand, reward, nextState});
+            totalReward += reward;
+            state = nextState;
+        }
+        
+        result.totalReward = totalReward;
+        result.averageReward = totalReward / steps;
+        
+        return result;
+    }
+    
+    void exportResults(const std::string& filename) {
+        std::ofstream outFile(filename);
+        
+        if (!outFile.is_open()) {
+            std::cerr << "Error opening file: " << filename << std::endl;
+            return;
+        }
+        
+        auto [s, S] = computeSSpolicy();
+        
+        outFile << "MDP Inventory Control - Results\n";
+        outFile << "================================\n\n";
+        outFile << "Configuration:\n";
+        outFile << "  Max Inventory: " << maxInventory << "\n";
+        outFile << "  Order Cost: $" << orderCost << "\n";
+        outFile << "  Holding Cost: $" << holdingCost << " per unit\n";
+        outFile << "  Stockout Cost: $" << stockoutCost << " per unit\n";
+        outFile << "  Selling Price: $" << sellingPrice << "\n";
+        outFile << "  Demand Mean: " << demandMean << "\n";
+        outFile << "  Demand Std: " << demandStd << "\n";
+        outFile << "  Discount Factor: " << gamma << "\n\n";
+        
+        outFile << "Optimal (s,S) Policy:\n";
+        outFile << "  s (reorder point): " << s << "\n";
+        outFile << "  S (order-up-to): " << S << "\n\n";
+        
+        outFile << "Policy (State -> Action):\n";
+        outFile << std::setw(8) << "State" << std::setw(12) << "Action" << std::setw(15) << "Value\n";
+        outFile << std::string(35, '-') << "\n";
+        
+        for (int state = 0; state <= std::min(30, maxInventory); ++state) {
+            outFile << std::setw(8) << state 
+                    << std::setw(12) << policy[state]
+                    << std::setw(15) << std::fixed << std::setprecision(2) << valueFunction[state] << "\n";
+        }
+        
+        outFile << "\nTransport Modes:\n";
+        for (const auto& [mode, data] : transportModes) {
+            outFile << "  " << mode << ": Cost=$" << data.cost << ", Time=" << data.time << " days\n";
+        }
+        
+        outFile.close();
+        std::cout << "Results exported to " << filename << std::endl;
+    }
+    
+    // Writes the full policy and value function as a one-entry policy pack
+    // that PolicyPack::open() maps back in place. epsilon records the
+    // tolerance the policy was solved to.
+    bool exportBinary(const std::string& filename, double epsilon = 0.01) {
+        auto entry = std::make_shared<CachedPolicy>();
+        entry->config = config();
+        entry->epsilon = epsilon;
+        auto [s, S] = computeSSpolicy();
+        entry->reorderPoint = s;
+        entry->orderUpTo = S;
+        entry->policy = policy;
+        entry->values.assign(valueFunction.begin(), valueFunction.end());
+        
+        PolicyPackWriter writer;
+        writer.add(entry);
+        return writer.write(filename);
+    }
+    
+    void printPolicy(int maxStates = 20) {
+        std::cout << "\nOptimal Policy (first " << maxStates << " states):\n";
+        std::cout << std::setw(8) << "State" << std::setw(12) << "Action" << std::setw(15) << "Value\n";
+        std::cout << std::string(35, '-') << "\n";
+        
+        for (int state = 0; state < std::min(maxStates, maxInventory + 1); ++state) {
+            std::cout << std::setw(8) << state 
+                      << std::setw(12) << policy[state]
+                      << std::setw(15) << std::fixed << std::setprecision(2) << valueFunction[state] << "\n";
+        }
+    }
+};
+
+using MDPEngine = BasicMDPEngine<double>;
+
+// Demand tables keyed by (mean, std), so engines with the same demand share
+// one copy.
+class DemandCache {
+private:
+    std::mutex mutex;
+    std::map<std::pair<double, double>, std::shared_ptr<const DemandDistribution>> entries;
+
+public:
+    std::shared_ptr<const DemandDistribution> get(double mean, double std) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& entry = entries[{mean, std}];
+        if (!entry) entry = std::make_shared<const DemandDistribution>(mean, std);
+        return entry;
+    }
+    
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+    }
+};
+
+// What-if grid over stockoutCost x holdingCost x demandStd around a base
+// configuration.
+struct ParameterGrid {
+    MDPConfig base;
+    std::vector<double> stockoutCosts;
+    std::vector<double> holdingCosts;
+    std::vector<double> demandStds;
+    
+    size_t size() const {
+        return stockoutCosts.size() * holdingCosts.size() * demandStds.size();
+    }
+};
+
+struct ParameterPoint {
+    double stockoutCost;
+    double holdingCost;
+    double demandStd;
+    int reorderPoint;
+    int orderUpTo;
+    double value;
+    int iterations;
+    bool converged;
+};
+
+// Solves every grid point. The points are walked in serpentine order (std
+// outermost, stockout cost innermost), so consecutive points differ in one
+// coordinate by one step, and each point is warm-started from the previous
+// one through reconfigure(). The walk is cut into one contiguous segment per
+// thread; only segment heads start cold. Results come back in grid order,
+// stockout cost varying fastest.
+class ParameterSweep {
+private:
+    ParameterGrid grid;
+    SolverOptions options;
+    int threads;
+    DemandCache demandCache;
+    
+    // Serpentine walk over (std, holding, stockout) index triples.
+    std::vector<size_t> walk() const {
+        size_t stockouts = grid.stockoutCosts.size();
+        size_t holdings = grid.holdingCosts.size();
+        std::vector<size_t> order;
+        order.reserve(grid.size());
+        size_t row = 0;
+        for (size_t k = 0; k < grid.demandStds.size(); ++k) {
+            for (size_t jj = 0; jj < holdings; ++jj, ++row) {
+                size_t j = (k % 2 == 0) ? jj : holdings - 1 - jj;
+                for (size_t ii = 0; ii < stockouts; ++ii) {
+                    size_t i = (row % 2 == 0) ? ii : stockouts - 1 - ii;
+                    order.push_back((k * holdings + j) * stockouts + i);
+                }
+            }
+        }
+        return order;
+    }
+    
+    MDPConfig configAt(size_t index) const {
+        size_t stockouts = grid.stockoutCosts.size();
+        size_t holdings = grid.holdingCosts.size();
+        MDPConfig config = grid.base;
+        config.stockoutCost = grid.stockoutCosts[index % stockouts];
+        config.holdingCost = grid.holdingCosts[(index / stockouts) % holdings];
+        config.demandStd = grid.demandStds[index / (stockouts * holdings)];
+        return config;
+    }
+
+public:
+    ParameterSweep(const ParameterGrid& parameterGrid, const SolverOptions& solverOptions = SolverOptions(),
+                   int numThreads = static_cast<int>(std::thread::hardware_concurrency()))
+        : grid(parameterGrid), options(solverOptions), threads(std::max(1, numThreads)) {
+        // Parallelism comes from the segments; each engine sweeps on one thread.
+        options.numThreads = 1;
+    }
+    
+    std::vector<ParameterPoint> run(double epsilon = 0.01, int maxIterations = 1000, int initialState = 0) {
+        std::vector<ParameterPoint> results(grid.size());
+        std::vector<size_t> order = walk();
+        if (order.empty()) return results;
+        
+        int segments = std::min<int>(threads, static_cast<int>(order.size()));
+        size_t segmentSize = (order.size() + segments - 1) / segments;
+        segments = static_cast<int>((order.size() + segmentSize - 1) / segmentSize);
+        
+        ThreadPool workers(segments);
+        workers.run(segments, [&](int segment) {
+            size_t begin = segment * segmentSize;
+            size_t end = std::min(order.size(), begin + segmentSize);
+            std::unique_ptr<MDPEngine> engine;
+            
+            for (size_t position = begin; position < end; ++position) {
+                size_t index = order[position];
+                MDPConfig config = configAt(index);
+                auto demand = demandCache.get(config.demandMean, config.demandStd);
+                if (!engine) {
+                    engine = std::make_unique<MDPEngine>(config);
+                    engine->setSolverOptions(options);
+                }
+                engine->reconfigure(config, demand);
+                
+                ConvergenceInfo info = engine->valueIteration(epsilon, maxIterations);
+                auto [reorderPoint, orderUpTo] = engine->computeSSpolicy();
+                int state = std::min(std::max(0, initialState), config.maxInventory);
+                results[index] = {config.stockoutCost, config.holdingCost, config.demandStd, reorderPoint,
+                                  orderUpTo, engine->stateValue(state), info.iterations, info.converged};
+            }
+        });
+        
+        return results;
+    }
+    
+    size_t sharedDemandTables() {
+        return demandCache.size();
+    }
+};
+
+// Solves many small SKUs at once. SKUs with the same maxInventory are packed
+// Lanes to a block, and each block stores its tables structure-of-arrays:
+// entry [i * Lanes + lane] belongs to the lane's SKU. A sweep then runs the
+// post-decision backup of every lane side by side, so the inner loops run
+// across SKUs and vectorize. Blocks are swept on a ThreadPool. Each lane
+// stops on the sup-norm test on its own; a converged lane keeps its V and
+// policy while the rest of its block finishes.
+class BatchMDPSolver {
+public:
+    static constexpr int Lanes = 8;
+    
+    struct SkuResult {
+        int reorderPoint;
+        int orderUpTo;
+        int iterations;
+        bool converged;
+    };
+    
+    struct BatchReport {
+        size_t skus;
+        size_t blocks;
+        double seconds;
+        double skusPerSecond;
+    };
+
+private:
+    struct Block {
+        int states = 0;
+        int support = 0;
+        int lanes = 0;
+        std::array<int, Lanes> skus{};
+        AlignedVector<double> values;
+        AlignedVector<double> continuation;
+        AlignedVector<double> rewards;
+        AlignedVector<double> pmf;
+        AlignedVector<double> tail;
+        std::vector<int> policy;
+        alignas(64) std::array<double, Lanes> gamma{};
+        alignas(64) std::array<double, Lanes> unitCost{};
+        alignas(64) std::array<double, Lanes> fixedCost{};
+        alignas(64) std::array<double, Lanes> delta{};
+        alignas(64) std::array<double, Lanes> active{};
+    };
+    
+    std::vector<MDPConfig> configs;
+    std::vector<Block> blocks;
+    std::vector<SkuResult> results;
+    // (block, lane) of each SKU.
+    std::vector<std::pair<int, int>> location;
+    KernelIsa isa;
+    int threads;
+    
+    using Sweep = void (*)(Block&);
+    
+    // One Jacobi post-decision sweep of every lane; the scalar twin of
+    // MDPEngine::postDecisionBackup, with the lane loop innermost.
+    __attribute__((always_inline))
+    static inline void sweepBlock(Block& block) {
+        const int states = block.states;
+        const int support = block.support;
+        double* values = block.values.data();
+        double* continuation = block.continuation.data();
+        const double* rewards = block.rewards.data();
+        const double* pmf = block.pmf.data();
+        const double* tail = block.tail.data();
+        int* policy = block.policy.data();
+        
+        for (int level = 0; level < states; ++level) {
+            alignas(64) double expected[Lanes] = {};
+            int interior = std::min(level, support - 1);
+            for (int d = 0; d <= interior; ++d) {
+                const double* p = pmf + d * Lanes;
+                const double* v = values + (level - d) * Lanes;
+                for (int lane = 0; lane < Lanes; ++lane) expected[lane] += p[lane] * v[lane];
+            }
+            if (level < support) {
+                const double* t = tail + level * Lanes;
+                for (int lane = 0; lane < Lanes; ++lane) expected[lane] += t[lane] * values[lane];
+            }
+            for (int lane = 0; lane < Lanes; ++lane) continuation[level * Lanes + lane] = expected[lane];
+        }
+        
+        alignas(64) double bestOrderValue[Lanes];
+        alignas(64) double delta[Lanes] = {};
+        int bestLevel[Lanes];
+        for (int lane = 0; lane < Lanes; ++lane) {
+            bestOrderValue[lane] = -std::numeric_limits<double>::infinity();
+            bestLevel[lane] = states - 1;
+        }
+        
+        for (int state = states - 1; state >= 0; --state) {
+            double* v = values + state * Lanes;
+            int* a = policy + state * Lanes;
+            const double* r = rewards + state * Lanes;
+            const double* g = continuation + state * Lanes;
+            for (int lane = 0; lane < Lanes; ++lane) {
+                double future = block.gamma[lane] * g[lane];
+                double holdValue = r[lane] + future;
+                double orderValue = r[lane] - block.fixedCost[lane] + block.unitCost[lane] * state +
+                                    bestOrderValue[lane];
+                bool ordering = orderValue > holdValue;
+                double newValue = ordering ? orderValue : holdValue;
+                int action = ordering ? bestLevel[lane] - state : 0;
+                
+                double levelValue = future - block.unitCost[lane] * state;
+                if (levelValue >= bestOrderValue[lane]) {
+                    bestOrderValue[lane] = levelValue;
+                    bestLevel[lane] = state;
+                }
+                
+                delta[lane] = std::max(delta[lane], std::abs(v[lane] - newValue));
+                bool live = block.active[lane] != 0.0;
+                v[lane] = live ? newValue : v[lane];
+                a[lane] = live ? action : a[lane];
+            }
+        }
+        
+        for (int lane = 0; lane < Lanes; ++lane) block.delta[lane] = delta[lane];
+    }
+    
+    static void sweepScalar(Block& block) {
+        sweepBlock(block);
+    }
+
+#ifdef MDP_ENGINE_X86_KERNELS
+    __attribute__((target("avx2,fma")))
+    static void sweepAvx2(Block& block) {
+        sweepBlock(block);
+    }
+    
+    __attribute__((target("avx512f")))
+    static void sweepAvx512(Block& block) {
+        sweepBlock(block);
+    }
+#endif
+    
+    static Sweep sweepFor(KernelIsa isa) {
+#ifdef MDP_ENGINE_X86_KERNELS
+        switch (BellmanKernels<double>::select(isa).isa) {
+            case KernelIsa::Avx512: return sweepAvx512;
+            case KernelIsa::Avx2: return sweepAvx2;
+            default: break;
+        }
+#endif
+        (void)isa;
+        return sweepScalar;
+    }
+    
+    // Loads one SKU into a lane. Lanes with a narrower demand support keep
+    // zeros in the padded pmf and tail rows.
+    static void loadLane(Block& block, int lane, const MDPConfig& config, const DemandDistribution& demand) {
+        double mass = demand.totalMass();
+        for (int d = 0; d < demand.support(); ++d) {
+            block.pmf[d * Lanes + lane] = demand.probability(d);
+            block.tail[d * Lanes + lane] = demand.tailMass(d);
+        }
+        for (int state = 0; state < block.states; ++state) {
+            block.rewards[state * Lanes + lane] = config.sellingPrice * demand.expectedSales(state) -
+                                                  config.holdingCost * state * mass -
+                                                  config.stockoutCost * demand.expectedShortage(state);
+        }
+        block.gamma[lane] = config.gamma;
+        block.unitCost[lane] = 5.0 * mass;
+        block.fixedCost[lane] = config.orderCost * mass;
+        block.active[lane] = 1.0;
+    }
+    
+    void buildBlocks() {
+        std::map<int, std::vector<int>> byStates;
+        for (size_t sku = 0; sku < configs.size(); ++sku) {
+            byStates[configs[sku].maxInventory].push_back(static_cast<int>(sku));
+        }
+        
+        // Within a group, neighbouring lanes get similar demand supports, so
+        // little of each block's convolution runs over padding.
+        DemandCache demandCache;
+        for (auto& [maxInventory, skus] : byStates) {
+            std::stable_sort(skus.begin(), skus.end(), [&](int a, int b) {
+                return configs[a].demandMean + 4 * configs[a].demandStd <
+                       configs[b].demandMean + 4 * configs[b].demandStd;
+            });
+            for (size_t first = 0; first < skus.size(); first += Lanes) {
+                Block block;
+                block.states = maxInventory + 1;
+                block.lanes = static_cast<int>(std::min<size_t>(Lanes, skus.size() - first));
+                
+                std::vector<std::shared_ptr<const DemandDistribution>> demands;
+                for (int lane = 0; lane < block.lanes; ++lane) {
+                    const MDPConfig& config = configs[skus[first + lane]];
+                    demands.push_back(demandCache.get(config.demandMean, config.demandStd));
+                    block.support = std::max(block.support, demands.back()->support());
+                    block.skus[lane] = skus[first + lane];
+                    location[skus[first + lane]] = {static_cast<int>(blocks.size()), lane};
+                }
+                
+                size_t cells = static_cast<size_t>(block.states) * Lanes;
+                block.values.assign(cells, 0.0);
+                block.continuation.assign(cells, 0.0);
+                block.rewards.assign(cells, 0.0);
+                block.policy.assign(cells, 0);
+                block.pmf.assign(static_cast<size_t>(block.support) * Lanes, 0.0);
+                block.tail.assign(static_cast<size_t>(block.support) * Lanes, 0.0);
+                for (int lane = 0; lane < block.lanes; ++lane) {
+                    loadLane(block, lane, configs[block.skus[lane]], *demands[lane]);
+                }
+                blocks.push_back(std::move(block));
+            }
+        }
+    }
+    
+    // Same rule as MDPEngine::computeSSpolicy, read from one lane.
+    static std::pair<int, int> ssPolicy(const Block& block, int lane) {
+        int maxInventory = block.states - 1;
+        int reorderPoint = -1;
+        long long levelSum = 0;
+        int ordering = 0;
+        for (int state = 0; state <= maxInventory; ++state) {
+            int action = block.policy[state * Lanes + lane];
+            if (action > 0) {
+                reorderPoint = state;
+                levelSum += state + action;
+                ++ordering;
+            }
+        }
+        if (ordering == 0) return {maxInventory / 3, 2 * maxInventory / 3};
+        return {reorderPoint, static_cast<int>(levelSum / ordering)};
+    }
+
+public:
+    explicit BatchMDPSolver(std::vector<MDPConfig> skuConfigs, KernelIsa kernelIsa = KernelIsa::Auto,
+                            int numThreads = static_cast<int>(std::thread::hardware_concurrency()))
+        : configs(std::move(skuConfigs)), location(configs.size()), isa(kernelIsa),
+          threads(std::max(1, numThreads)) {
+        buildBlocks();
+        results.assign(configs.size(), {0, 0, 0, false});
+    }
+    
+    // Every SKU starts active; a repeated call continues from the current
+    // values and counts its own sweeps.
+    BatchReport solve(double epsilon = 0.01, int maxIterations = 1000) {
+        Sweep sweep = sweepFor(isa);
+        auto start = std::chrono::steady_clock::now();
+        
+        ThreadPool workers(std::min<int>(threads, std::max<int>(1, static_cast<int>(blocks.size()))));
+        workers.run(static_cast<int>(blocks.size()), [&](int index) {
+            Block& block = blocks[index];
+            std::array<int, Lanes> iterations{};
+            std::array<bool, Lanes> converged{};
+            int remaining = block.lanes;
+            for (int lane = 0; lane < block.lanes; ++lane) {
+                block.active[lane] = 1.0;
+                block.delta[lane] = 0.0;
+            }
+            
+            for (int iteration = 0; iteration < maxIterations && remaining > 0; ++iteration) {
+                sweep(block);
+                for (int lane = 0; lane < block.lanes; ++lane) {
+                    if (block.active[lane] == 0.0) continue;
+                    iterations[lane] = iteration + 1;
+                    if (block.delta[lane] < epsilon) {
+                        converged[lane] = true;
+                        block.active[lane] = 0.0;
+                        --remaining;
+                    }
+                }
+            }
+            
+            for (int lane = 0; lane < block.lanes; ++lane) {
+                auto [reorderPoint, orderUpTo] = ssPolicy(block, lane);
+                results[block.skus[lane]] = {reorderPoint, orderUpTo, iterations[lane], converged[lane]};
+            }
+        });
+        
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return {configs.size(), blocks.size(), seconds, (seconds > 0.0) ? configs.size() / seconds : 0.0};
+    }
+    
+    const SkuResult& result(int sku) const {
+        return results[sku];
+    }
+    
+    size_t size() const {
+        return configs.size();
+    }
+    
+    double value(int sku, int state) const {
+        auto [block, lane] = location[sku];
+        return blocks[block].values[state * Lanes + lane];
+    }
+    
+    int action(int sku, int state) const {
+        auto [block, lane] = location[sku];
+        return blocks[block].policy[state * Lanes + lane];
+    }
+};
+
+// Solves independent SKUs as jobs on a WorkStealingScheduler. Solve times
+// vary by orders of magnitude, so jobs start largest estimated cost first.
+// A job whose estimate reaches splitCost also hands the scheduler to its
+// engine: its chunked sweeps then split into tasks that idle workers steal
+// once the small jobs run out. Only Jacobi and red-black standard sweeps,
+// the generic post-decision continuation (N + 1 above the fixed-size
+// kernels, or fixedSizeKernels off) and policy evaluation are chunked;
+// Gauss-Seidel sweeps and fixed-size post-decision kernels stay one task.
+class SkuJobScheduler {
+public:
+    struct JobResult {
+        int reorderPoint;
+        int orderUpTo;
+        ConvergenceInfo info;
+        double seconds;
+        // The engine was handed the scheduler for its sweeps.
+        bool split;
+    };
+    
+    // Work per sweep over sweeps to converge. A full-scan sweep scores
+    // about N^2 / 2 actions, a post-decision sweep N levels, each over the
+    // demand support; value iteration needs on the order of 1 / (1 - gamma)
+    // sweeps.
+    static double estimateCost(const MDPConfig& config, const SolverOptions& options) {
+        double states = config.maxInventory + 1.0;
+        double support = std::max(0.0, std::floor(config.demandMean + 4 * config.demandStd)) + 1.0;
+        double perSweep = (options.backup == BackupMode::PostDecision)
+            ? states * support
+            : 0.5 * states * (states + 1.0) * support;
+        return perSweep / (1.0 - std::min(config.gamma, 0.9999));
+    }
+
+private:
+    WorkStealingScheduler scheduler;
+    double splitCost;
+
+public:
+    explicit SkuJobScheduler(int numThreads = static_cast<int>(std::thread::hardware_concurrency()),
+                             double splitThreshold = 5e8)
+        : scheduler(std::max(1, numThreads)), splitCost(splitThreshold) {}
+    
+    std::vector<JobResult> solve(const std::vector<MDPConfig>& configs, const SolverOptions& options = SolverOptions(),
+                                 double epsilon = 0.01, int maxIterations = 1000) {
+        std::vector<JobResult> results(configs.size());
+        SolverOptions jobOptions = options;
+        // Jobs get their threads from the scheduler, never from a pool of
+        // their own.
+        jobOptions.numThreads = 1;
+        
+        for (size_t index = 0; index < configs.size(); ++index) {
+            double cost = estimateCost(configs[index], jobOptions);
+            scheduler.submit([&, index, cost] {
+                auto start = std::chrono::steady_clock::now();
+                MDPEngine engine(configs[index]);
+                engine.setSolverOptions(jobOptions);
+                JobResult& result = results[index];
+                result.split = cost >= splitCost;
+                if (result.split) engine.setExecutor(&scheduler);
+                
+                result.info = engine.valueIteration(epsilon, maxIterations);
+                auto [reorderPoint, orderUpTo] = engine.computeSSpolicy();
+                result.reorderPoint = reorderPoint;
+                result.orderUpTo = orderUpTo;
+                result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            }, cost);
+        }
+        scheduler.wait();
+        return results;
+    }
+    
+    long long steals() const {
+        return scheduler.steals();
+    }
+};
+
+// Solved policies keyed by MDPConfig::hash(), in front of the solver. The
+// memory tier is an LRU split into shards, each behind its own mutex, so
+// concurrent lookups rarely contend. An optional directory adds a disk tier
+// of one file per configuration; a memory miss checks it before solving.
+// Entries are immutable and handed out as shared_ptr, so an eviction never
+// invalidates a policy a caller still holds. A hit needs an entry solved at
+// least as tightly as the requested epsilon. Concurrent misses on the same
+// configuration may both solve it; the later insert wins.
+class PolicyCache {
+public:
+    struct Statistics {
+        long long hits;
+        long long misses;
+        long long evictions;
+        long long diskHits;
+        long long diskWrites;
+    };
+
+private:
+    static constexpr int Shards = 16;
+    
+    struct Shard {
+        std::mutex mutex;
+        // Most recently used first.
+        std::list<std::shared_ptr<const CachedPolicy>> recency;
+        std::unordered_map<uint64_t, std::list<std::shared_ptr<const CachedPolicy>>::iterator> index;
+    };
+    
+    std::array<Shard, Shards> shards;
+    size_t shardCapacity;
+    std::string directory;
+    std::atomic<long long> hits{0};
+    std::atomic<long long> misses{0};
+    std::atomic<long long> evictions{0};
+    std::atomic<long long> diskHits{0};
+    std::atomic<long long> diskWrites{0};
+    
+    // The config hash, mixed with the solver options that change what a
+    // solve returns: the stopping rule decides what epsilon certifies, and
+    // extrapolation shifts V. Defaults leave the config hash unchanged.
+    static uint64_t keyFor(const MDPConfig& config, StoppingRule stopping, bool extrapolated) {
+        return config.hash() ^ (PolicyPackFormat::solverFlags(stopping, extrapolated) * 0x9e3779b97f4a7c15ULL);
+    }
+    
+    static uint64_t keyFor(const CachedPolicy& entry) {
+        return keyFor(entry.config, entry.stopping, entry.extrapolated);
+    }
+    
+    static bool matches(const CachedPolicy& entry, const MDPConfig& config, double epsilon,
+                        const SolverOptions& options) {
+        return entry.config == config && entry.epsilon <= epsilon && entry.stopping == options.stopping &&
+               entry.extrapolated == options.extrapolate;
+    }
+    
+    Shard& shardFor(uint64_t key) {
+        return shards[key >> 60];
+    }
+    
+    std::string pathFor(uint64_t key) const {
+        std::ostringstream name;
+        name << directory << "/" << std::hex << std::setw(16) << std::setfill('0') << key << ".pack";
+        return name.str();
+    }
+    
+    std::shared_ptr<const CachedPolicy> findInMemory(const MDPConfig& config, uint64_t key, double epsilon,
+                                                     const SolverOptions& options) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto found = shard.index.find(key);
+        if (found == shard.index.end()) return nullptr;
+        const auto& entry = *found->second;
+        if (!matches(*entry, config, epsilon, options)) return nullptr;
+        shard.recency.splice(shard.recency.begin(), shard.recency, found->second);
+        return entry;
+    }
+    
+    void insertInMemory(std::shared_ptr<const CachedPolicy> entry, uint64_t key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto found = shard.index.find(key);
+        if (found != shard.index.end()) {
+            shard.recency.erase(found->second);
+            shard.index.erase(found);
+        }
+        shard.recency.push_front(std::move(entry));
+        shard.index[key] = shard.recency.begin();
+        while (shard.recency.size() > shardCapacity) {
+            shard.index.erase(keyFor(*shard.recency.back()));
+            shard.recency.pop_back();
+            evictions.fetch_add(1);
+        }
+    }
+    
+    // Each entry is a one-policy PolicyPack. It is written to a per-thread
+    // temporary and renamed into place, so readers never see a partial file.
+    void writeToDisk(std::shared_ptr<const CachedPolicy> entry, uint64_t key) {
+        std::string path = pathFor(key);
+        std::ostringstream temporary;
+        temporary << path << ".tmp" << std::hash<std::thread::id>()(std::this_thread::get_id());
+        PolicyPackWriter writer;
+        writer.add(std::move(entry));
+        if (!writer.write(temporary.str())) return;
+        if (std::rename(temporary.str().c_str(), path.c_str()) == 0) {
+            diskWrites.fetch_add(1);
+        } else {
+            std::remove(temporary.str().c_str());
+        }
+    }
+    
+    // Reads a disk entry after checking the pack and the record checksums.
+    std::shared_ptr<const CachedPolicy> readFromDisk(const MDPConfig& config, uint64_t key, double epsilon,
+                                                     const SolverOptions& options) {
+        std::string path = pathFor(key);
+        if (!std::ifstream(path).good()) return nullptr;
+        auto pack = PolicyPack::open(path);
+        PolicyView view = pack ? pack->find(config) : PolicyView();
+        if (!view || !view.verify()) return nullptr;
+        
+        auto entry = std::make_shared<CachedPolicy>();
+        entry->config = view.config();
+        entry->epsilon = view.epsilon();
+        entry->stopping = view.stopping();
+        entry->extrapolated = view.extrapolated();
+        entry->reorderPoint = view.reorderPoint();
+        entry->orderUpTo = view.orderUpTo();
+        if (!matches(*entry, config, epsilon, options)) return nullptr;
+        entry->policy.assign(view.policy(), view.policy() + view.maxInventory() + 1);
+        entry->values.assign(view.values(), view.values() + view.maxInventory() + 1);
+        return entry;
+    }
+
+public:
+    // capacity counts entries across all shards; an empty directory turns
+    // the disk tier off.
+    explicit PolicyCache(size_t capacity = 4096, std::string diskDirectory = "")
+        : shardCapacity(std::max<size_t>(1, (capacity + Shards - 1) / Shards)),
+          directory(std::move(diskDirectory)) {}
+    
+    PolicyCache(const PolicyCache&) = delete;
+    PolicyCache& operator=(const PolicyCache&) = delete;
+    
+    // Cached policy for config solved to epsilon or tighter under the
+    // stopping rule and extrapolation of options, or nullptr.
+    std::shared_ptr<const CachedPolicy> find(const MDPConfig& config, double epsilon = 0.01,
+                                             const SolverOptions& options = SolverOptions()) {
+        uint64_t key = keyFor(config, options.stopping, options.extrapolate);
+        if (auto entry = findInMemory(config, key, epsilon, options)) {
+            hits.fetch_add(1);
+            return entry;
+        }
+        if (!directory.empty()) {
+            if (auto entry = readFromDisk(config, key, epsilon, options)) {
+                diskHits.fetch_add(1);
+                insertInMemory(entry, key);
+                return entry;
+            }
+        }
+        misses.fetch_add(1);
+        return nullptr;
+    }
+    
+    void insert(std::shared_ptr<const CachedPolicy> entry) {
+        uint64_t key = keyFor(*entry);
+        if (!directory.empty()) writeToDisk(entry, key);
+        insertInMemory(std::move(entry), key);
+    }
+    
+    // Snapshot of a solved engine's policy and values.
+    static std::shared_ptr<const CachedPolicy> capture(MDPEngine& engine, double epsilon) {
+        auto entry = std::make_shared<CachedPolicy>();
+        entry->config = engine.config();
+        entry->epsilon = epsilon;
+        entry->stopping = engine.solverOptions().stopping;
+        entry->extrapolated = engine.solverOptions().extrapolate;
+        auto [reorderPoint, orderUpTo] = engine.computeSSpolicy();
+        entry->reorderPoint = reorderPoint;
+        entry->orderUpTo = orderUpTo;
+        for (int state = 0; state <= entry->config.maxInventory; ++state) {
+            entry->policy.push_back(engine.action(state));
+            entry->values.push_back(engine.stateValue(state));
+        }
+        return entry;
+    }
+    
+    // The cached policy, or a fresh solve. Only a converged solve is cached:
+    // one stopped by maxIterations does not meet epsilon and is returned
+    // as is.
+    std::shared_ptr<const CachedPolicy> solve(const MDPConfig& config, const SolverOptions& options = SolverOptions(),
+                                              double epsilon = 0.01, int maxIterations = 1000) {
+        if (auto entry = find(config, epsilon, options)) return entry;
+        MDPEngine engine(config);
+        engine.setSolverOptions(options);
+        ConvergenceInfo info = engine.valueIteration(epsilon, maxIterations);
+        auto entry = capture(engine, epsilon);
+        if (info.converged) insert(entry);
+        return entry;
+    }
+    
+    Statistics statistics() const {
+        return {hits.load(), misses.load(), evictions.load(), diskHits.load(), diskWrites.load()};
+    }
+    
+    size_t size() {
+        size_t total = 0;
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.recency.size();
+        }
+        return total;
+    }
+};
+
+// Distribution of the lead time L of one order, on {0, ..., K}. Orders draw
+// their lead times independently, so a late order can be overtaken by a
+// later one. The solver and the simulator both use the precomputed hazards
+// h_j = P(L = j | L >= j): an order still in transit at age j (periods
+// since it was placed) arrives in this period's transition with
+// probability h_j, and h_K = 1.
+struct LeadTimeDistribution {
+    std::vector<double> probability;
+    
+    static LeadTimeDistribution deterministic(int periods) {
+        LeadTimeDistribution distribution;
+        distribution.probability.assign(std::max(0, periods) + 1, 0.0);
+        distribution.probability.back() = 1.0;
+        return distribution;
+    }
+    
+    // On time (L = nominal) with probability reliability; each period of
+    // delay after that ends with the same probability. Delays are cut at
+    // extraPeriods, which takes the remaining mass.
+    static LeadTimeDistribution fromReliability(int nominal, double reliability, int extraPeriods = 1) {
+        LeadTimeDistribution distribution;
+        int periods = std::max(0, nominal);
+        double r = std::min(1.0, std::max(0.0, reliability));
+        if (r >= 1.0) extraPeriods = 0;
+        distribution.probability.assign(periods + std::max(0, extraPeriods) + 1, 0.0);
+        double remaining = 1.0;
+        for (int delay = 0; delay < extraPeriods; ++delay) {
+            distribution.probability[periods + delay] = remaining * r;
+            remaining *= 1.0 - r;
+        }
+        distribution.probability.back() = remaining;
+        return distribution;
+    }
+    
+    int maxPeriods() const {
+        return static_cast<int>(probability.size()) - 1;
+    }
+    
+    std::vector<double> hazards() const {
+        std::vector<double> hazard(probability.size(), 0.0);
+        double survival = 1.0;
+        for (size_t age = 0; age < probability.size(); ++age) {
+            hazard[age] = (survival > 0.0) ? std::min(1.0, probability[age] / survival) : 1.0;
+            survival -= probability[age];
+        }
+        hazard.back() = 1.0;
+        return hazard;
+    }
+};
+
+// Inventory MDP with lead times of up to K periods. The state is the
+// on-hand stock x and the pipeline p_0..p_{K-1}, where p_i is the order
+// placed K - i periods ago that has not arrived yet. In each transition
+// every outstanding order of age j, the new order a at age 0 included,
+// arrives with hazard h_j, and the rest age by one period:
+//   x' = max(0, x + arrivals - D),   p' = (p_1, ..., p_{K-1}, a) minus arrivals,
+// with p_0 (age K) always arriving. A deterministic lead time L is K = L
+// with h_L = 1, and L = 0 is the model of MDPEngine (the order arrives at
+// once), solved here by a one-dimensional sweep that keeps the order cap.
+// The inventory position x + sum(p) + a is capped at maxInventory, and
+// each order at maxOrder.
+//
+// States use a mixed-radix code, on-hand fastest:
+//   index = x + (N+1) (p_0 + (Q+1) (p_1 + ... + (Q+1) p_{K-1})),
+// so every pipeline tuple t owns a contiguous fiber of on-hand levels.
+// Indices whose position exceeds N are unused. A sweep never builds
+// transition matrices or enumerates arrival patterns; it works backwards
+// through one transition:
+//   W(z, t)   = sum_d P(d) V(max(0, z - d), t)       1-D convolution per fiber
+//   U         = W, then for each slot i of t with hazard h < 1 in turn
+//   U(z, t)  <- h U(z + t_i, t with t_i = 0) + (1 - h) U(z, t)
+//   M(z, r)   = max_a gamma U(z, (r, a)) - ord(a)   along the newest slot
+//   V(x, p_0, r) = R(x) + M(x + p_0, r)
+// where ord(a) = mass (orderCost + transport cost + 5 a) for a > 0.
+// Each arrival stage is a two-term banded update, so a sweep costs
+// O(|S| (D + K)) instead of O(|S| Q D 2^K).
+class LeadTimeMDPEngine {
+public:
+    using SimulationStep = MDPEngine::SimulationStep;
+    using SimulationResult = MDPEngine::SimulationResult;
 
-class MDPEngine {
 private:
-    int maxInventory;
-    double orderCost;
-    double holdingCost;
-    double stockoutCost;
-    double sellingPrice;
-    double demandMean;
-    double demandStd;
-    double gamma;
+    MDPConfig config;
+    LeadTimeDistribution leadTimes;
+    std::vector<double> hazard;
+    int leadTime;
+    int maxOrder;
+    // Per-order transport costs on top of orderCost; forMode sets the
+    // regular one. Dual sourcing adds expedite orders of up to
+    // expediteLimit units that arrive at once.
+    int expediteLimit = 0;
+    double regularShipmentCost = 0.0;
+    double expediteShipmentCost = 0.0;
+    std::shared_ptr<const DemandDistribution> demandModel;
     
-    std::vector<double> valueFunction;
+    size_t fiberCount = 1;
+    size_t stateCount = 0;
+    // (Q+1)^(K-1): fibers per value of the newest pipeline slot.
+    size_t olderFibers = 1;
+    std::vector<int> fiberLoad;
+    std::vector<double> stateRewards;
+    std::vector<double> values;
+    std::vector<double> continuation;
+    std::vector<double> orderValues;
+    std::vector<int> orderActions;
+    // With an expedite mode: the best of expediting from z up to y and
+    // ordering at y, per (z, older fiber).
+    std::vector<double> positionValues;
+    std::vector<int> positionOrders;
+    std::vector<int> positionExpedites;
     std::vector<int> policy;
-    std::vector<std::vector<double>> qValues;
-    
+    std::vector<int> expeditePolicy;
+    std::deque<int> immediateWindow;
+    const ContinuationKernels<double>::Entry* fixedKernel = nullptr;
+    KernelIsa isa;
+    std::unique_ptr<ThreadPool> pool;
     std::random_device rd;
     std::mt19937 gen;
-    std::normal_distribution<double> demandDist;
     
-    struct TransportMode {
-        double cost;
-        int time;
-    };
+    template <typename Body>
+    void forEachFiber(size_t count, const Body& body) {
+        int threads = pool ? pool->size() : 1;
+        int chunks = static_cast<int>(std::max<size_t>(1, std::min<size_t>(count, threads * 16)));
+        size_t chunkSize = (count + chunks - 1) / chunks;
+        std::function<void(int)> run = [&](int chunk) {
+            size_t begin = chunk * chunkSize;
+            size_t end = std::min(count, begin + chunkSize);
+            for (size_t fiber = begin; fiber < end; ++fiber) body(fiber);
+        };
+        if (pool) {
+            pool->run(chunks, run);
+        } else {
+            for (int chunk = 0; chunk < chunks; ++chunk) run(chunk);
+        }
+    }
     
-    std::map<std::string, TransportMode> transportModes;
-
-public:
-    MDPEngine(int maxInv, double ordCost, double holdCost, double stockCost, 
-              double sellPrice, double demMean, double demStd, double discountFactor)
-        : maxInventory(maxInv), orderCost(ordCost), holdingCost(holdCost),
-          stockoutCost(stockCost), sellingPrice(sellPrice), demandMean(demMean),
-          demandStd(demStd), gamma(discountFactor), gen(rd()), 
-          demandDist(demandMean, demandStd) {
-        
-        valueFunction.resize(maxInventory + 1, 0.0);
-        policy.resize(maxInventory + 1, 0);
-        qValues.resize(maxInventory + 1, std::vector<double>(maxInventory + 1, 0.0));
+    void convolveFiber(const double* v, double* out) {
+        int states = config.maxInventory + 1;
+        if (fixedKernel) {
+            fixedKernel->kernel(isa)(v, states, demandModel->pmfData(), demandModel->tailData(),
+                                     demandModel->support(), out);
+            return;
+        }
+        for (int level = 0; level < states; ++level) out[level] = convolveLevel(v, level);
+    }
+    
+    double convolveLevel(const double* v, int level) const {
+        int maxDemand = demandModel->maxValue();
+        const double* pmf = demandModel->pmfData();
+        double expected = 0.0;
+        for (int d = 0; d <= std::min(level, maxDemand); ++d) expected += pmf[d] * v[level - d];
+        return expected + demandModel->tailMass(level) * v[0];
+    }
+    
+    // Takes the expectation over whether the order in post-transition slot
+    // i arrived. That order was h = hazard[K - 1 - i] likely to arrive; if it
+    // did, its units joined z and the slot is empty. Fibers with an empty
+    // slot i are only read, so fibers update in place and in parallel.
+    void arrivalStage(int slot) {
+        double h = hazard[leadTime - 1 - slot];
+        if (h == 0.0) return;
+        int states = config.maxInventory + 1;
+        size_t radix = 1;
+        for (int i = 0; i < slot; ++i) radix *= maxOrder + 1;
         
-        transportModes["truck"] = {100.0, 1};
-        transportModes["ship"] = {50.0, 3};
-        transportModes["rail"] = {75.0, 2};
-        transportModes["air"] = {200.0, 0};
+        forEachFiber(fiberCount, [&](size_t fiber) {
+            int quantity = static_cast<int>((fiber / radix) % (maxOrder + 1));
+            if (quantity == 0) return;
+            double* target = continuation.data() + fiber * states;
+            const double* arrived = continuation.data() + (fiber - quantity * radix) * states + quantity;
+            for (int level = 0; level + quantity < states; ++level) {
+                target[level] = h * arrived[level] + (1.0 - h) * target[level];
+            }
+        });
     }
     
-    double normalPDF(double x, double mean, double std) {
-        const double PI = 3.14159265358979323846;
-        double exponent = -0.5 * std::pow((x - mean) / std, 2);
-        return (1.0 / (std * std::sqrt(2 * PI))) * std::exp(exponent);
+    // Continuation U(z, t) of the current values: demand, then arrivals.
+    void buildContinuation() {
+        int states = config.maxInventory + 1;
+        forEachFiber(fiberCount, [&](size_t fiber) {
+            convolveFiber(values.data() + fiber * states, continuation.data() + fiber * states);
+        });
+        if (fixedKernel) fixedKernel->hits += static_cast<long long>(fiberCount);
+        for (int slot = 0; slot < leadTime; ++slot) {
+            arrivalStage(slot);
+        }
     }
     
-    double demandProbability(int d) {
-        if (d < 0) return 0.0;
-        return normalPDF(static_cast<double>(d), demandMean, demandStd);
+    // Expediting from z to y costs mass (orderCost + shipment + 5 (y - z)),
+    // so the best y > z is a sliding-window max of M(y) - 5 mass y over
+    // z < y <= min(z + limit, hi), kept in a monotone deque while z falls.
+    // Ties go to the smaller expedite quantity.
+    void expediteStage(size_t older, std::deque<int>& window) {
+        int states = config.maxInventory + 1;
+        double mass = demandModel->totalMass();
+        double unitCost = 5.0 * mass;
+        double fixedCost = (config.orderCost + expediteShipmentCost) * mass;
+        const double* m = orderValues.data() + older * states;
+        const int* orders = orderActions.data() + older * states;
+        double* bestValues = positionValues.data() + older * states;
+        int* bestOrders = positionOrders.data() + older * states;
+        int* bestExpedites = positionExpedites.data() + older * states;
+        auto score = [&](int y) { return m[y] - unitCost * y; };
+        
+        int hi = config.maxInventory - fiberLoad[older];
+        window.clear();
+        for (int z = hi; z >= 0; --z) {
+            if (z + 1 <= hi) {
+                while (!window.empty() && score(window.back()) <= score(z + 1)) window.pop_back();
+                window.push_back(z + 1);
+            }
+            while (!window.empty() && window.front() > z + expediteLimit) window.pop_front();
+            bestValues[z] = m[z];
+            bestOrders[z] = orders[z];
+            bestExpedites[z] = 0;
+            if (!window.empty()) {
+                int y = window.front();
+                double candidate = score(y) + unitCost * z - fixedCost;
+                if (candidate > m[z]) {
+                    bestValues[z] = candidate;
+                    bestOrders[z] = orders[y];
+                    bestExpedites[z] = y - z;
+                }
+            }
+        }
     }
     
-    double immediateReward(int state, int action, int demand) {
-        int sales = std::min(state, demand);
-        double revenue = sales * sellingPrice;
-        double holding = state * holdingCost;
-        double ordering = (action > 0) ? (orderCost + action * 5.0) : 0.0;
-        double stockout = std::max(0, demand - state) * stockoutCost;
-        return revenue - holding - ordering - stockout;
+    // One Jacobi sweep; returns the sup-norm change over valid states.
+    double sweep() {
+        int states = config.maxInventory + 1;
+        double mass = demandModel->totalMass();
+        double unitCost = 5.0 * mass;
+        double fixedCost = (config.orderCost + regularShipmentCost) * mass;
+        
+        buildContinuation();
+        
+        // M over (z, r): r is an older-slot fiber, the newest slot is a.
+        forEachFiber(olderFibers, [&](size_t older) {
+            for (int level = 0; level < states; ++level) {
+                int room = config.maxInventory - level - fiberLoad[older];
+                double best = (room >= 0) ? config.gamma * continuation[older * states + level] : 0.0;
+                int bestAction = 0;
+                for (int a = 1; a <= std::min(room, maxOrder); ++a) {
+                    size_t fiber = older + olderFibers * a;
+                    double candidate = config.gamma * continuation[fiber * states + level] - fixedCost - unitCost * a;
+                    if (candidate > best) {
+                        best = candidate;
+                        bestAction = a;
+                    }
+                }
+                orderValues[older * states + level] = best;
+                orderActions[older * states + level] = bestAction;
+            }
+            if (expediteLimit > 0) {
+                thread_local std::deque<int> window;
+                expediteStage(older, window);
+            }
+        });
+        
+        // V(x, p_0, r) = R(x) + M(x + p_0, r); fibers are (p_0, r) with p_0 fastest.
+        const std::vector<double>& best = (expediteLimit > 0) ? positionValues : orderValues;
+        const std::vector<int>& bestOrders = (expediteLimit > 0) ? positionOrders : orderActions;
+        std::vector<double> fiberDelta(fiberCount, 0.0);
+        forEachFiber(fiberCount, [&](size_t fiber) {
+            size_t older = fiber / (maxOrder + 1);
+            int arriving = static_cast<int>(fiber % (maxOrder + 1));
+            double delta = 0.0;
+            for (int x = 0; x + fiberLoad[fiber] <= config.maxInventory; ++x) {
+                size_t state = fiber * states + x;
+                size_t orderState = older * states + x + arriving;
+                double updated = stateRewards[x] + best[orderState];
+                delta = std::max(delta, std::abs(updated - values[state]));
+                values[state] = updated;
+                policy[state] = bestOrders[orderState];
+                if (expediteLimit > 0) expeditePolicy[state] = positionExpedites[orderState];
+            }
+            fiberDelta[fiber] = delta;
+        });
+        return *std::max_element(fiberDelta.begin(), fiberDelta.end());
     }
     
-    std::pair<double, int> bellmanUpdate(int state) {
-        double maxValue = -std::numeric_limits<double>::infinity();
-        int bestAction = 0;
-        int maxAction = std::min(maxInventory - state, maxInventory);
+    // Lead time 0: the order joins the stock at once, as in MDPEngine, so
+    //   V(x) = R(x) + max(gamma W(x), max_y gamma W(y) - ord(y - x)),
+    // over x < y <= min(x + maxOrder, N). As in expediteStage, the best y is
+    // a sliding-window max of gamma W(y) - 5 mass y kept in a monotone deque
+    // while x falls; without a cap it is MDPEngine's running max. W is one
+    // fiber, so a wide one without a fixed-size kernel splits by level.
+    double immediateSweep() {
+        int states = config.maxInventory + 1;
+        double mass = demandModel->totalMass();
+        double unitCost = 5.0 * mass;
+        double fixedCost = (config.orderCost + regularShipmentCost) * mass;
         
-        for (int action = 0; action <= maxAction; ++action) {
-            double expectedValue = 0.0;
-            int maxDemand = static_cast<int>(demandMean + 4 * demandStd);
-            
-            for (int demand = 0; demand <= maxDemand; ++demand) {
-                double prob = demandProbability(demand);
-                double reward = immediateReward(state, action, demand);
-                int nextState = std::max(0, std::min(maxInventory, state + action - demand));
-                expectedValue += prob * (reward + gamma * valueFunction[nextState]);
+        if (fixedKernel) {
+            convolveFiber(values.data(), continuation.data());
+            fixedKernel->hits++;
+        } else {
+            forEachFiber(states, [&](size_t level) {
+                continuation[level] = convolveLevel(values.data(), static_cast<int>(level));
+            });
+        }
+        auto score = [&](int y) { return config.gamma * continuation[y] - unitCost * y; };
+        
+        std::deque<int>& window = immediateWindow;
+        window.clear();
+        double delta = 0.0;
+        for (int x = states - 1; x >= 0; --x) {
+            if (x + 1 < states) {
+                while (!window.empty() && score(window.back()) <= score(x + 1)) window.pop_back();
+                window.push_back(x + 1);
             }
-            
-            qValues[state][action] = expectedValue;
-            
-            if (expectedValue > maxValue) {
-                maxValue = expectedValue;
-                bestAction = action;
+            while (!window.empty() && window.front() > x + maxOrder) window.pop_front();
+            double best = config.gamma * continuation[x];
+            int bestAction = 0;
+            if (!window.empty()) {
+                int y = window.front();
+                double candidate = score(y) + unitCost * x - fixedCost;
+                if (candidate > best) {
+                    best = candidate;
+                    bestAction = y - x;
+                }
+            }
+            double updated = stateRewards[x] + best;
+            delta = std::max(delta, std::abs(updated - values[x]));
+            values[x] = updated;
+            policy[x] = bestAction;
+        }
+        return delta;
+    }
+    
+    // Advances one period: places the orders, draws demand and arrivals
+    // and returns the period's reward, as in MDPEngine::simulateEpisode.
+    // inTransit holds the outstanding quantity by age.
+    double simulateStep(int& onHand, std::vector<int>& inTransit, int expedite, int order, std::mt19937& rng,
+                        int& demand) {
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        demand = demandModel->sample(rng);
+        double reward = std::min(onHand, demand) * config.sellingPrice - onHand * config.holdingCost -
+                        std::max(0, demand - onHand) * config.stockoutCost;
+        if (order > 0) reward -= config.orderCost + order * 5.0 + regularShipmentCost;
+        if (expedite > 0) reward -= config.orderCost + expedite * 5.0 + expediteShipmentCost;
+        
+        inTransit[0] = order;
+        int arriving = expedite;
+        for (int age = 0; age <= leadTime; ++age) {
+            if (inTransit[age] > 0 && (hazard[age] >= 1.0 || uniform(rng) < hazard[age])) {
+                arriving += inTransit[age];
+                inTransit[age] = 0;
+            }
+        }
+        std::rotate(inTransit.rbegin(), inTransit.rbegin() + 1, inTransit.rend());
+        onHand = std::max(0, std::min(config.maxInventory, onHand + arriving - demand));
+        return reward;
+    }
+
+
+public:
+    LeadTimeMDPEngine(const MDPConfig& mdpConfig, const LeadTimeDistribution& distribution, int orderLimit = -1,
+                      int numThreads = 1, KernelIsa kernelIsa = KernelIsa::Auto)
+        : config(mdpConfig), leadTimes(distribution), hazard(distribution.hazards()),
+          leadTime(distribution.maxPeriods()),
+          maxOrder((orderLimit < 0) ? mdpConfig.maxInventory : std::min(orderLimit, mdpConfig.maxInventory)),
+          isa(BellmanKernels<double>::select(kernelIsa).isa), gen(rd()) {
+        demandModel = std::make_shared<const DemandDistribution>(config.demandMean, config.demandStd);
+        int states = config.maxInventory + 1;
+        for (int slot = 0; slot < leadTime; ++slot) fiberCount *= maxOrder + 1;
+        olderFibers = fiberCount / (maxOrder + 1);
+        stateCount = fiberCount * states;
+        
+        // Units in transit per fiber, from the digits of its pipeline code.
+        fiberLoad.assign(fiberCount, 0);
+        for (size_t fiber = 0; fiber < fiberCount; ++fiber) {
+            for (size_t code = fiber; code > 0; code /= maxOrder + 1) {
+                fiberLoad[fiber] += static_cast<int>(code % (maxOrder + 1));
             }
         }
         
-        return {maxValue, bestAction};
+        double mass = demandModel->totalMass();
+        stateRewards.resize(states);
+        for (int x = 0; x < states; ++x) {
+            stateRewards[x] = config.sellingPrice * demandModel->expectedSales(x) -
+                              config.holdingCost * x * mass - config.stockoutCost * demandModel->expectedShortage(x);
+        }
+        values.assign(stateCount, 0.0);
+        continuation.assign(stateCount, 0.0);
+        policy.assign(stateCount, 0);
+        orderValues.assign(olderFibers * states, 0.0);
+        orderActions.assign(olderFibers * states, 0);
+        fixedKernel = ContinuationKernels<double>::select(states, demandModel->support());
+        if (numThreads > 1) pool = std::make_unique<ThreadPool>(numThreads);
     }
     
-    struct ConvergenceInfo {
-        bool converged;
-        int iterations;
-        double finalDelta;
-        std::vector<double> deltaHistory;
-    };
+    LeadTimeMDPEngine(const MDPConfig& mdpConfig, int periods, int orderLimit = -1, int numThreads = 1,
+                      KernelIsa kernelIsa = KernelIsa::Auto)
+        : LeadTimeMDPEngine(mdpConfig, LeadTimeDistribution::deterministic(periods), orderLimit, numThreads,
+                            kernelIsa) {}
+    
+    // Shipping by one of engine's transport modes: its transit time, late
+    // with probability 1 - reliability by up to extraPeriods, and its cost
+    // charged on every order the solver places.
+    static std::unique_ptr<LeadTimeMDPEngine> forMode(const MDPEngine& engine, const std::string& mode,
+                                                      int orderLimit = -1, int numThreads = 1,
+                                                      int extraPeriods = 1) {
+        auto distribution = LeadTimeDistribution::fromReliability(
+            engine.transportTime(mode), engine.transportReliability(mode), extraPeriods);
+        auto single = std::make_unique<LeadTimeMDPEngine>(engine.config(), distribution, orderLimit, numThreads);
+        single->regularShipmentCost = engine.transportCost(mode);
+        return single;
+    }
+    
+    // Dual sourcing: regular orders by regularMode, with its lead-time
+    // distribution, and expedite orders by expediteMode, which must have no
+    // transit time and is taken to arrive at once. Each order pays orderCost
+    // plus its mode's transport cost, and both share orderLimit.
+    static std::unique_ptr<LeadTimeMDPEngine> forDualSourcing(const MDPEngine& engine, const std::string& expediteMode,
+                                                              const std::string& regularMode, int orderLimit = -1,
+                                                              int numThreads = 1, int extraPeriods = 1) {
+        if (engine.transportTime(expediteMode) != 0) {
+            std::cerr << "Expedite mode " << expediteMode << " has a transit time of "
+                      << engine.transportTime(expediteMode) << " periods" << std::endl;
+            return nullptr;
+        }
+        auto dual = forMode(engine, regularMode, orderLimit, numThreads, extraPeriods);
+        int limit = (orderLimit < 0) ? engine.config().maxInventory : orderLimit;
+        if (!dual->enableExpedite(limit, engine.transportCost(expediteMode), engine.transportCost(regularMode))) {
+            return nullptr;
+        }
+        return dual;
+    }
+    
+    // Adds the expedite mode. The action becomes (expedite, regular order),
+    // and the best pair costs one sliding-window max per older fiber on top
+    // of the regular max, so a sweep stays O(|S| (D + K)). Needs at least
+    // one pipeline slot.
+    bool enableExpedite(int limit, double expediteShipment, double regularShipment) {
+        if (leadTime == 0) {
+            std::cerr << "Expediting needs a regular lead time of at least one period" << std::endl;
+            return false;
+        }
+        int states = config.maxInventory + 1;
+        expediteLimit = std::max(0, std::min(limit, config.maxInventory));
+        expediteShipmentCost = expediteShipment;
+        regularShipmentCost = regularShipment;
+        positionValues.assign(olderFibers * states, 0.0);
+        positionOrders.assign(olderFibers * states, 0);
+        positionExpedites.assign(olderFibers * states, 0);
+        expeditePolicy.assign(stateCount, 0);
+        return true;
+    }
+    
+    // Longest lead time K, which is also the number of pipeline slots.
+    int periods() const {
+        return leadTime;
+    }
+    
+    const LeadTimeDistribution& distribution() const {
+        return leadTimes;
+    }
+    
+    // Encoded states, including the unused ones.
+    size_t states() const {
+        return stateCount;
+    }
+    
+    size_t encode(int onHand, const std::vector<int>& pipeline) const {
+        size_t code = 0;
+        for (int slot = leadTime - 1; slot >= 0; --slot) {
+            code = code * (maxOrder + 1) + pipeline[slot];
+        }
+        return code * (config.maxInventory + 1) + onHand;
+    }
+    
+    void decode(size_t index, int& onHand, std::vector<int>& pipeline) const {
+        onHand = static_cast<int>(index % (config.maxInventory + 1));
+        size_t code = index / (config.maxInventory + 1);
+        pipeline.assign(leadTime, 0);
+        for (int slot = 0; slot < leadTime; ++slot) {
+            pipeline[slot] = static_cast<int>(code % (maxOrder + 1));
+            code /= maxOrder + 1;
+        }
+    }
     
     ConvergenceInfo valueIteration(double epsilon = 0.01, int maxIterations = 1000) {
         ConvergenceInfo info;
-        info.converged = false;
-        info.iterations = 0;
-        
         for (int iteration = 0; iteration < maxIterations; ++iteration) {
-            double delta = 0.0;
-            
-            for (int state = 0; state <= maxInventory; ++state) {
-                auto [newValue, bestAction] = bellmanUpdate(state);
-                delta = std::max(delta, std::abs(valueFunction[state] - newValue));
-                valueFunction[state] = newValue;
-                policy[state] = bestAction;
-            }
-            
+            double delta = (leadTime == 0) ? immediateSweep() : sweep();
             info.deltaHistory.push_back(delta);
             info.iterations = iteration + 1;
             info.finalDelta = delta;
-            
+            info.backups += static_cast<long long>(stateCount);
             if (delta < epsilon) {
                 info.converged = true;
                 break;
             }
         }
-        
         return info;
     }
     
-    std::pair<int, int> computeSSpolicy() {
-        std::vector<int> reorderPoints;
-        std::vector<int> orderUpTo;
-        
-        for (int state = 0; state <= maxInventory; ++state) {
-            if (policy[state] > 0) {
-                reorderPoints.push_back(state);
-                orderUpTo.push_back(state + policy[state]);
-            }
-        }
-        
-        int s = reorderPoints.empty() ? maxInventory / 3 : *std::max_element(reorderPoints.begin(), reorderPoints.end());
-        int S = orderUpTo.empty() ? (2 * maxInventory / 3) : 
-                std::accumulate(orderUpTo.begin(), orderUpTo.end(), 0) / orderUpTo.size();
-        
-        return {s, S};
+    // pipeline[i] is the order placed K - i periods ago; it must hold K
+    // entries.
+    int action(int onHand, const std::vector<int>& pipeline) const {
+        return policy[encode(onHand, pipeline)];
     }
     
-    int generateDemand() {
-        int demand = static_cast<int>(std::round(demandDist(gen)));
-        return std::max(0, demand);
+    double value(int onHand, const std::vector<int>& pipeline) const {
+        return values[encode(onHand, pipeline)];
     }
     
-    struct SimulationStep {
-        int step;
-        int state;
-        int action;
-        int demand;
-        double reward;
-        int nextState;
-    };
-    
-    struct SimulationResult {
-        std::vector<SimulationStep> trajectory;
-        double totalReward;
-        double averageReward;
-    };
+    // Units to expedite; always 0 without an expedite mode.
+    int expedite(int onHand, const std::vector<int>& pipeline) const {
+        return (expediteLimit > 0) ? expeditePolicy[encode(onHand, pipeline)] : 0;
+    }
     
-    SimulationResult simulateEpisode(int initialState, int steps, const std::string& transportMode) {
+    // Same accounting as MDPEngine::simulateEpisode, with the shipment costs
+    // the solver optimized, but each order draws its arrival period by
+    // period from the hazards, so orders can cross. Expedited units arrive
+    // at once. Starts with an empty pipeline; state and nextState in the
+    // trajectory are on-hand, and action is the regular order.
+    SimulationResult simulateEpisode(int initialState, int steps) {
         SimulationResult result;
-        int state = initialState;
+        int onHand = initialState;
+        // Outstanding quantity by age.
+        std::vector<int> inTransit(leadTime + 1, 0);
+        std::vector<int> pipeline(leadTime, 0);
         double totalReward = 0.0;
         
         for (int step = 0; step < steps; ++step) {
-            int action = policy[state];
-            int demand = generateDemand();
-            double reward = immediateReward(state, action, demand);
-            
-            if (action > 0 && transportModes.find(transportMode) != transportModes.end()) {
-                reward -= transportModes[transportMode].cost;
-            }
-            
-            int nextState = std::max(0, std::min(maxInventory, state + action - demand));
+            for (int slot = 0; slot < leadTime; ++slot) pipeline[slot] = inTransit[leadTime - slot];
+            int state = onHand;
+            int order = action(onHand, pipeline);
+            int demand = 0;
+            double reward = simulateStep(onHand, inTransit, expedite(state, pipeline), order, gen, demand);
             
-            result.trajectory.push_back({step, state, action, demand, reward, nextState});
+            result.trajectory.push_back({step, state, order, demand, reward, onHand});
             totalReward += reward;
-            state = nextState;
         }
         
         result.totalReward = totalReward;
         result.averageReward = totalReward / steps;
-        
         return result;
     }
-    
-    void exportResults(const std::string& filename) {
-        std::ofstream outFile(filename);
-        
-        if (!outFile.is_open()) {
-            std::cerr << "Error opening file: " << filename << std::endl;
-            return;
-        }
-        
-        auto [s, S] = computeSSpolicy();
-        
-        outFile << "MDP Inventory Control - Results\n";
-        outFile << "================================\n\n";
-        outFile << "Configuration:\n";
-        outFile << "  Max Inventory: " << maxInventory << "\n";
-        outFile << "  Order Cost: $" << orderCost << "\n";
-        outFile << "  Holding Cost: $" << holdingCost << " per unit\n";
-        outFile << "  Stockout Cost: $" << stockoutCost << " per unit\n";
-        outFile << "  Selling Price: $" << sellingPrice << "\n";
-        outFile << "  Demand Mean: " << demandMean << "\n";
-        outFile << "  Demand Std: " << demandStd << "\n";
-        outFile << "  Discount Factor: " << gamma << "\n\n";
-        
-        outFile << "Optimal (s,S) Policy:\n";
-        outFile << "  s (reorder point): " << s << "\n";
-        outFile << "  S (order-up-to): " << S << "\n\n";
-        
-        outFile << "Policy (State -> Action):\n";
-        outFile << std::setw(8) << "State" << std::setw(12) << "Action" << std::setw(15) << "Value\n";
-        outFile << std::string(35, '-') << "\n";
-        
-        for (int state = 0; state <= std::min(30, maxInventory); ++state) {
-            outFile << std::setw(8) << state 
-                    << std::setw(12) << policy[state]
-                    << std::setw(15) << std::fixed << std::setprecision(2) << valueFunction[state] << "\n";
-        }
-        
-        outFile << "\nTransport Modes:\n";
-        for (const auto& [mode, data] : transportModes) {
-            outFile << "  " << mode << ": Cost=$" << data.cost << ", Time=" << data.time << " days\n";
-        }
-        
-        outFile.close();
-        std::cout << "Results exported to " << filename << std::endl;
-    }
-    
-    void printPolicy(int maxStates = 20) {
-        std::cout << "\nOptimal Policy (first " << maxStates << " states):\n";
-        std::cout << std::setw(8) << "State" << std::setw(12) << "Action" << std::setw(15) << "Value\n";
-        std::cout << std::string(35, '-') << "\n";
-        
-        for (int state = 0; state < std::min(maxStates, maxInventory + 1); ++state) {
-            std::cout << std::setw(8) << state 
-                      << std::setw(12) << policy[state]
-                      << std::setw(15) << std::fixed << std::setprecision(2) << valueFunction[state] << "\n";
-        }
-    }
 };
 
 int main() {
@@ -270,6 +4676,160 @@ int main() {
     std::cout << "  Iterations: " << convergenceInfo.iterations << std::endl;
     std::cout << "  Final Delta: " << convergenceInfo.finalDelta << std::endl;
     
+    std::cout << "\nSweep Schedules (iterations to epsilon):" << std::endl;
+    for (const auto& report : engine.compareSweepSchedules(0.01, 1000)) {
+        std::cout << "  " << std::setw(24) << std::left << MDPEngine::sweepScheduleName(report.schedule)
+                  << std::right << std::setw(6) << report.iterations
+                  << (report.converged ? "" : " (not converged)") << std::endl;
+    }
+    
+    std::cout << "\nAcceleration (sweeps to epsilon):" << std::endl;
+    for (const auto& report : engine.compareAcceleration(0.01, 1000)) {
+        std::cout << "  " << std::setw(24) << std::left << report.method
+                  << std::right << std::setw(6) << report.iterations
+                  << std::setw(10) << std::fixed << std::setprecision(4) << report.seconds << "s"
+                  << (report.converged ? "" : " (not converged)") << std::endl;
+    }
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+    
+    MDPEngine prunedEngine(engine.config());
+    MDPEngine::SolverOptions pruningOptions;
+    pruningOptions.structuralPruning = true;
+    prunedEngine.setSolverOptions(pruningOptions);
+    auto pruningInfo = prunedEngine.valueIteration(0.01, 1000);
+    std::cout << "\nStructural Pruning:" << std::endl;
+    std::cout << "  Iterations: " << pruningInfo.iterations << "  full-scan sweeps: " << pruningInfo.fullScanSweeps
+              << "  fallback: " << (pruningInfo.pruningFallback ? "yes" : "no")
+              << (pruningInfo.converged ? "" : " (not converged)") << std::endl;
+    
+    std::cout << "\nPost-decision kernel dispatch (hits):" << std::endl;
+    MDPEngine postDecisionEngine(100, 50.0, 2.0, 20.0, 15.0, 10.0, 3.0, 0.95);
+    MDPEngine::SolverOptions postDecisionOptions;
+    postDecisionOptions.backup = MDPEngine::BackupMode::PostDecision;
+    postDecisionEngine.setSolverOptions(postDecisionOptions);
+    postDecisionEngine.valueIteration(0.01, 1000);
+    ContinuationKernels<double>::report(std::cout);
+    std::cout << std::setprecision(6);
+
+    std::cout << "\nPrioritized Sweeping (backups to epsilon, then to re-solve at demand mean 10.5):" << std::endl;
+    MDPConfig shiftedDemand = engine.config();
+    shiftedDemand.demandMean = 10.5;
+    MDPEngine sweepingEngine(engine.config());
+    MDPEngine prioritizedEngine(engine.config());
+    auto sweepingCold = sweepingEngine.valueIteration(0.01, 1000);
+    auto prioritizedCold = prioritizedEngine.prioritizedSweeping(0.01);
+    sweepingEngine.reconfigure(shiftedDemand);
+    prioritizedEngine.reconfigure(shiftedDemand);
+    auto sweepingWarm = sweepingEngine.valueIteration(0.01, 1000);
+    auto prioritizedWarm = prioritizedEngine.prioritizedSweeping(0.01);
+    std::cout << "  " << std::setw(24) << std::left << "Value iteration" << std::right
+              << std::setw(8) << sweepingCold.backups << std::setw(8) << sweepingWarm.backups << std::endl;
+    std::cout << "  " << std::setw(24) << std::left << "Prioritized sweeping" << std::right
+              << std::setw(8) << prioritizedCold.backups << std::setw(8) << prioritizedWarm.backups
+              << (prioritizedCold.converged && prioritizedWarm.converged ? "" : " (not converged)") << std::endl;
+
+    std::cout << "\nParameter Sweep (stockout x holding x demand std):" << std::endl;
+    ParameterGrid grid;
+    grid.stockoutCosts = {10.0, 20.0, 40.0};
+    grid.holdingCosts = {1.0, 2.0};
+    grid.demandStds = {2.0, 3.0};
+    ParameterSweep sweep(grid);
+    for (const auto& point : sweep.run(0.01, 1000)) {
+        std::cout << "  p=" << std::setw(4) << point.stockoutCost
+                  << " h=" << std::setw(3) << point.holdingCost
+                  << " std=" << std::setw(3) << point.demandStd
+                  << "  (s,S)=(" << point.reorderPoint << "," << point.orderUpTo << ")"
+                  << "  V(0)=" << std::fixed << std::setprecision(2) << point.value
+                  << "  iterations=" << point.iterations
+                  << (point.converged ? "" : " (not converged)") << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+    }
+    std::cout << std::setprecision(6);
+
+    std::vector<MDPConfig> skus;
+    for (int sku = 0; sku < 1024; ++sku) {
+        MDPConfig config;
+        config.maxInventory = (sku % 2 == 0) ? 60 : 120;
+        config.demandMean = 6.0 + (sku % 7);
+        config.demandStd = 1.5 + 0.25 * (sku % 5);
+        config.stockoutCost = 10.0 + 2.0 * (sku % 11);
+        skus.push_back(config);
+    }
+    BatchMDPSolver batch(std::move(skus));
+    auto batchReport = batch.solve(0.01, 1000);
+    std::cout << "\nBatch Solver:" << std::endl;
+    std::cout << "  SKUs: " << batchReport.skus << " in " << batchReport.blocks << " blocks of "
+              << BatchMDPSolver::Lanes << " lanes" << std::endl;
+    std::cout << "  Throughput: " << std::fixed << std::setprecision(0) << batchReport.skusPerSecond
+              << " SKUs/sec" << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+
+    std::vector<MDPConfig> jobs;
+    for (int sku = 0; sku < 64; ++sku) {
+        MDPConfig config;
+        config.maxInventory = (sku % 16 == 0) ? 2000 : 40 + 10 * (sku % 6);
+        config.demandMean = 6.0 + (sku % 9);
+        jobs.push_back(config);
+    }
+    MDPEngine::SolverOptions jobOptions;
+    jobOptions.backup = MDPEngine::BackupMode::PostDecision;
+    // The default threshold of 5e8 only reaches large standard-backup jobs;
+    // 5e5 splits the N = 2000 post-decision jobs, whose continuation is the
+    // generic chunked one.
+    SkuJobScheduler jobScheduler(static_cast<int>(std::thread::hardware_concurrency()), 5e5);
+    auto jobStart = std::chrono::steady_clock::now();
+    auto jobResults = jobScheduler.solve(jobs, jobOptions, 0.01, 1000);
+    double jobSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - jobStart).count();
+    double longestJob = 0.0;
+    int splitJobs = 0;
+    for (const auto& result : jobResults) {
+        longestJob = std::max(longestJob, result.seconds);
+        splitJobs += result.split ? 1 : 0;
+    }
+    std::cout << "\nWork-Stealing Jobs:" << std::endl;
+    std::cout << "  Jobs: " << jobResults.size() << "  split: " << splitJobs
+              << "  steals: " << jobScheduler.steals() << std::endl;
+    std::cout << "  Wall time: " << std::fixed << std::setprecision(4) << jobSeconds
+              << "s (longest job " << longestJob << "s)" << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+
+    PolicyCache policyCache(256);
+    std::vector<MDPConfig> requests;
+    for (int call = 0; call < 40; ++call) {
+        MDPConfig config;
+        config.stockoutCost = 10.0 + 5.0 * (call % 8);
+        requests.push_back(config);
+    }
+    auto cacheStart = std::chrono::steady_clock::now();
+    for (const auto& config : requests) policyCache.solve(config);
+    double cacheSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - cacheStart).count();
+    auto cacheStats = policyCache.statistics();
+    std::cout << "\nPolicy Cache:" << std::endl;
+    std::cout << "  Requests: " << requests.size() << "  hits: " << cacheStats.hits
+              << "  misses: " << cacheStats.misses << "  evictions: " << cacheStats.evictions << std::endl;
+    std::cout << "  Total time: " << std::fixed << std::setprecision(4) << cacheSeconds << "s" << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+
+    std::cout << "\nCheckpoint and Resume:" << std::endl;
+    MDPEngine::SolverOptions checkpointOptions;
+    checkpointOptions.checkpointInterval = 10;
+    checkpointOptions.checkpointPath = "mdp_engine_checkpoint.bin";
+    MDPEngine interrupted(engine.config());
+    interrupted.setSolverOptions(checkpointOptions);
+    auto partialInfo = interrupted.valueIteration(0.01, 25);
+    MDPEngine resumed(engine.config());
+    resumed.setSolverOptions(checkpointOptions);
+    if (resumed.resumeFromCheckpoint(checkpointOptions.checkpointPath)) {
+        auto resumedInfo = resumed.valueIteration(0.01, 1000);
+        std::cout << "  Stopped after " << partialInfo.iterations << " sweeps, resumed to "
+                  << resumedInfo.iterations << " (" << (resumedInfo.converged ? "converged" : "not converged")
+                  << ")" << std::endl;
+    }
+    
     auto [s, S] = engine.computeSSpolicy();
     std::cout << "\nOptimal (s,S) Policy:" << std::endl;
     std::cout << "  s (reorder point): " << s << std::endl;
@@ -282,7 +4842,41 @@ int main() {
     std::cout << "  Total Reward: $" << std::fixed << std::setprecision(2) << simResult.totalReward << std::endl;
     std::cout << "  Average Reward: $" << simResult.averageReward << std::endl;
     
+    std::cout << "\nLead-Time Models (orders up to 40 units, late by up to one period):" << std::endl;
+    int leadTimeThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    for (const std::string mode : {"air", "truck", "rail"}) {
+        auto leadTimeEngine = LeadTimeMDPEngine::forMode(engine, mode, 40, leadTimeThreads);
+        auto leadTimeInfo = leadTimeEngine->valueIteration(0.01, 1000);
+        auto leadTimeSim = leadTimeEngine->simulateEpisode(50, 30);
+        std::cout << "  " << std::setw(6) << std::left << mode << std::right
+                  << " L=" << engine.transportTime(mode) << ".." << leadTimeEngine->periods()
+                  << "  on-time=" << std::setprecision(0) << 100.0 * engine.transportReliability(mode) << "%"
+                  << std::setprecision(2)
+                  << "  states=" << std::setw(7) << leadTimeEngine->states()
+                  << "  iterations=" << std::setw(4) << leadTimeInfo.iterations
+                  << "  Average Reward: $" << leadTimeSim.averageReward << std::endl;
+    }
+    
+    std::cout << "\nDual Sourcing (air expedite, truck regular, orders up to 40 units):" << std::endl;
+    auto dualSourcing = LeadTimeMDPEngine::forDualSourcing(engine, "air", "truck", 40);
+    if (dualSourcing) {
+        auto dualInfo = dualSourcing->valueIteration(0.01, 1000);
+        std::vector<int> emptyPipeline(dualSourcing->periods(), 0);
+        std::cout << "  " << dualInfo.iterations << " sweeps over " << dualSourcing->states()
+                  << " states, V(0, empty) = " << dualSourcing->value(0, emptyPipeline)
+                  << ", expedite " << dualSourcing->expedite(0, emptyPipeline) << " + order "
+                  << dualSourcing->action(0, emptyPipeline) << " at zero stock" << std::endl;
+    }
+    
     engine.exportResults("mdp_engine_results.txt");
+    if (engine.exportBinary("mdp_engine_policy.pack")) {
+        auto pack = PolicyPack::open("mdp_engine_policy.pack");
+        PolicyView view = pack ? pack->find(engine.config()) : PolicyView();
+        if (view && view.verify()) {
+            std::cout << "Binary policy reloaded: " << (view.maxInventory() + 1) << " states, (s,S) = ("
+                      << view.reorderPoint() << "," << view.orderUpTo() << ")" << std::endl;
+        }
+    }
     
     std::cout << "\n=== Execution Complete ===" << std::endl;
     